@@ -24,12 +24,15 @@
 #include "proto/mythprotoevent.h"
 #include "private/os/threads/thread.h"
 #include "private/os/threads/event.h"
+#include "private/os/threads/threadpool.h"
 #include "private/cppdef.h"
 #include "private/builtin.h"
 
 #include <vector>
 #include <map>
 #include <list>
+#include <deque>
+#include <set>
 
 using namespace Myth;
 
@@ -50,100 +53,135 @@ EventHandler::EventHandlerThread::~EventHandlerThread()
 
 ///////////////////////////////////////////////////////////////////////////////
 ////
-//// SubscriptionHandlerThread
+//// Subscription
 ////
 
+#define SUBSCRIPTION_WORKERS        4     // Pool threads delivering the messages
+#define SUBSCRIPTION_QUEUE_SIZE     256   // Pending messages kept per subscription
+
 namespace Myth
 {
-  class SubscriptionHandlerThread : private OS::CThread
+  /**
+   * Queue of the messages pending for a subscriber. The messages are shared by
+   * all the subscriptions and must not be modified. A queue is drained by one
+   * worker of the dispatcher pool at a time, so a subscriber receives its
+   * messages in order and never concurrently. When the subscriber is too slow
+   * the oldest messages are dropped. For the events the subscriber wants the
+   * latest value only, a queued message is replaced by a newer one with the
+   * same key.
+   */
+  class Subscription
   {
   public:
-    SubscriptionHandlerThread(EventSubscriber *handle, unsigned subid);
-    virtual ~SubscriptionHandlerThread();
-    EventSubscriber *GetHandle() { return m_handle; }
-    bool IsRunning() { return OS::CThread::IsRunning(); }
-    void PostMessage(const EventMessage& msg);
+    Subscription(EventSubscriber *handle, unsigned subid);
+    EventSubscriber *GetHandle() const { return m_handle; }
+    void SetLatestOnly(EVENT_t event);
+    /// Returns true when a worker must be scheduled to deliver the queue
+    bool PostMessage(const EventMessagePtr& msg, const std::string& key);
+    void Deliver();
+    /// Drop the pending messages and wait for the delivery in progress
+    void Revoke();
 
   private:
     EventSubscriber *m_handle;
     unsigned m_subId;
-    mutable OS::CMutex m_mutex;
-    OS::CEvent m_queueContent;
-    std::list<EventMessagePtr> m_msgQueue;
+    OS::CMutex m_mutex;
+    OS::CCondition<volatile bool> m_condition;
+    volatile bool m_idle;
+    bool m_revoked;
+    std::set<EVENT_t> m_latestOnly;
+    typedef std::pair<std::string, EventMessagePtr> QueueItem; ///< coalescing key, message
+    std::deque<QueueItem> m_msgQueue;
+  };
+
+  typedef MYTH_SHARED_PTR<Subscription> SubscriptionPtr;
 
-    bool Start();
-    void Stop();
-    void *Process();
+  class SubscriptionWorker : public OS::CWorker
+  {
+  public:
+    SubscriptionWorker(const SubscriptionPtr& subscription) : m_subscription(subscription) { }
+    virtual void Process() { m_subscription->Deliver(); }
+
+  private:
+    SubscriptionPtr m_subscription;
   };
 }
 
-SubscriptionHandlerThread::SubscriptionHandlerThread(EventSubscriber *handle, unsigned subid)
-: OS::CThread()
-, m_handle(handle)
+Subscription::Subscription(EventSubscriber *handle, unsigned subid)
+: m_handle(handle)
 , m_subId(subid)
 , m_mutex()
-, m_queueContent()
+, m_condition()
+, m_idle(true)
+, m_revoked(false)
+, m_latestOnly()
 , m_msgQueue()
 {
-  if (m_handle && Start())
-    DBG(DBG_DEBUG, "%s: subscription is started (%p:%u)\n", __FUNCTION__, m_handle, m_subId);
-  else
-    DBG(DBG_ERROR, "%s: subscription failed (%p:%u)\n", __FUNCTION__, m_handle, m_subId);
 }
 
-SubscriptionHandlerThread::~SubscriptionHandlerThread()
+void Subscription::SetLatestOnly(EVENT_t event)
 {
-  Stop();
-  m_handle = NULL;
-}
-
-bool SubscriptionHandlerThread::Start()
-{
-  if (OS::CThread::IsRunning())
-    return true;
-  return OS::CThread::StartThread();
+  OS::CLockGuard lock(m_mutex);
+  m_latestOnly.insert(event);
 }
 
-void SubscriptionHandlerThread::Stop()
+bool Subscription::PostMessage(const EventMessagePtr& msg, const std::string& key)
 {
-  if (OS::CThread::IsRunning())
+  // Critical section
+  OS::CLockGuard lock(m_mutex);
+  if (m_revoked)
+    return false;
+  if (m_latestOnly.find(msg->event) != m_latestOnly.end())
   {
-    DBG(DBG_DEBUG, "%s: subscription thread (%p:%u)\n", __FUNCTION__, m_handle, m_subId);
-    // Set stopping. don't wait as we need to signal the thread first
-    OS::CThread::StopThread(false);
-    m_queueContent.Signal();
-    // Wait for thread to stop
-    OS::CThread::StopThread(true);
-    DBG(DBG_DEBUG, "%s: subscription thread (%p:%u) stopped\n", __FUNCTION__, m_handle, m_subId);
+    // Replace the older value still queued, the most recent being at the back
+    for (std::deque<QueueItem>::reverse_iterator it = m_msgQueue.rbegin(); it != m_msgQueue.rend(); ++it)
+    {
+      if (it->first == key && it->second->event == msg->event)
+      {
+        it->second = msg;
+        return false;
+      }
+    }
+    m_msgQueue.push_back(std::make_pair(key, msg));
   }
+  else
+    m_msgQueue.push_back(std::make_pair(std::string(), msg));
+  if (m_msgQueue.size() > SUBSCRIPTION_QUEUE_SIZE)
+  {
+    DBG(DBG_WARN, "%s: subscription (%p:%u) is overflowed\n", __FUNCTION__, m_handle, m_subId);
+    m_msgQueue.pop_front();
+  }
+  if (!m_idle)
+    return false;
+  m_idle = false;
+  return true;
 }
 
-void SubscriptionHandlerThread::PostMessage(const EventMessage& msg)
+void Subscription::Deliver()
 {
   // Critical section
   OS::CLockGuard lock(m_mutex);
-  m_msgQueue.push_back(EventMessagePtr(new EventMessage(msg)));
-  m_queueContent.Signal();
+  while (!m_revoked && !m_msgQueue.empty())
+  {
+    EventMessagePtr msg = m_msgQueue.front().second;
+    m_msgQueue.pop_front();
+    lock.Unlock();
+    // Do work
+    m_handle->HandleBackendMessage(msg);
+    lock.Lock();
+  }
+  m_idle = true;
+  m_condition.Broadcast();
 }
 
-void *SubscriptionHandlerThread::Process()
+void Subscription::Revoke()
 {
-  while (!IsStopped())
-  {
-    while (!m_msgQueue.empty() && !IsStopped())
-    {
-      // Critical section
-      OS::CLockGuard lock(m_mutex);
-      EventMessagePtr msg = m_msgQueue.front();
-      m_msgQueue.pop_front();
-      lock.Unlock();
-      // Do work
-      m_handle->HandleBackendMessage(msg);
-    }
-    // The tread is woken up by m_queueContent.Signal();
-    m_queueContent.Wait();
-  }
-  return NULL;
+  // Critical section
+  OS::CLockGuard lock(m_mutex);
+  m_revoked = true;
+  m_msgQueue.clear();
+  m_condition.Wait(m_mutex, m_idle);
+  DBG(DBG_DEBUG, "%s: subscription (%p:%u) is revoked\n", __FUNCTION__, m_handle, m_subId);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -153,7 +191,7 @@ void *SubscriptionHandlerThread::Process()
 
 namespace Myth
 {
-  class BasicEventHandler : public EventHandler::EventHandlerThread, private OS::CThread
+  class BasicEventHandler : public EventHandler::EventHandlerThread, private OS::CThread, private ProtoEventFilter
   {
   public:
     BasicEventHandler(const std::string& server, unsigned port);
@@ -165,21 +203,26 @@ namespace Myth
     virtual bool IsRunning();
     virtual bool IsConnected();
     virtual unsigned CreateSubscription(EventSubscriber *sub);
-    virtual bool SubscribeForEvent(unsigned subid, EVENT_t event);
+    virtual bool SubscribeForEvent(unsigned subid, EVENT_t event, bool latestOnly);
     virtual void RevokeSubscription(unsigned subid);
     virtual void RevokeAllSubscriptions(EventSubscriber *sub);
+    // Implements ProtoEventFilter
+    virtual unsigned GetEventMask();
 
   private:
     OS::CMutex m_mutex;
     ProtoEvent *m_event;
     bool m_reset;
+    unsigned m_eventMask;               ///< Events having subscriptions
     // About subscriptions
     typedef std::map<EVENT_t, std::list<unsigned> > subscriptionsByEvent_t;
     subscriptionsByEvent_t m_subscriptionsByEvent;
-    typedef std::map<unsigned, SubscriptionHandlerThread*> subscriptions_t;
+    typedef std::map<unsigned, SubscriptionPtr> subscriptions_t;
     subscriptions_t m_subscriptions;
+    OS::CThreadPool m_dispatcher;
 
-    void DispatchEvent(const EventMessage& msg);
+    static std::string CoalescingKey(const EventMessage& msg);
+    void DispatchEvent(const EventMessagePtr& msg);
     virtual void* Process(void);
     void AnnounceStatus(const char *status);
     void AnnounceTimer();
@@ -191,19 +234,24 @@ BasicEventHandler::BasicEventHandler(const std::string& server, unsigned port)
 : EventHandlerThread(server, port), OS::CThread()
 , m_event(new ProtoEvent(server,port))
 , m_reset(false)
+, m_eventMask(0)
+, m_dispatcher(SUBSCRIPTION_WORKERS)
 {
 }
 
 BasicEventHandler::~BasicEventHandler()
 {
   Stop();
+  std::vector<SubscriptionPtr> revoked;
   {
     OS::CLockGuard lock(m_mutex);
     for (subscriptions_t::iterator it = m_subscriptions.begin(); it != m_subscriptions.end(); ++it)
-      delete it->second;
+      revoked.push_back(it->second);
     m_subscriptions.clear();
     m_subscriptionsByEvent.clear();
   }
+  for (std::vector<SubscriptionPtr>::iterator it = revoked.begin(); it != revoked.end(); ++it)
+    (*it)->Revoke();
   SAFE_DELETE(m_event);
 }
 
@@ -245,28 +293,27 @@ bool BasicEventHandler::IsConnected()
 unsigned BasicEventHandler::CreateSubscription(EventSubscriber* sub)
 {
   unsigned id = 0;
+  if (!sub)
+    return 0;
   OS::CLockGuard lock(m_mutex);
   subscriptions_t::const_reverse_iterator it = m_subscriptions.rbegin();
   if (it != m_subscriptions.rend())
     id = it->first;
-  SubscriptionHandlerThread *handler = new SubscriptionHandlerThread(sub, ++id);
-  if (handler->IsRunning())
-  {
-    m_subscriptions.insert(std::make_pair(id, handler));
-    return id;
-  }
-  // Handler didn't start
-  delete handler;
-  return 0;
+  ++id;
+  m_subscriptions.insert(std::make_pair(id, SubscriptionPtr(new Subscription(sub, id))));
+  DBG(DBG_DEBUG, "%s: subscription is created (%p:%u)\n", __FUNCTION__, sub, id);
+  return id;
 }
 
-bool BasicEventHandler::SubscribeForEvent(unsigned subid, EVENT_t event)
+bool BasicEventHandler::SubscribeForEvent(unsigned subid, EVENT_t event, bool latestOnly)
 {
   OS::CLockGuard lock(m_mutex);
   // Only for registered subscriber
   subscriptions_t::const_iterator it1 = m_subscriptions.find(subid);
   if (it1 == m_subscriptions.end())
     return false;
+  if (latestOnly)
+    it1->second->SetLatestOnly(event);
   std::list<unsigned>::const_iterator it2 = m_subscriptionsByEvent[event].begin();
   while (it2 != m_subscriptionsByEvent[event].end())
   {
@@ -275,6 +322,7 @@ bool BasicEventHandler::SubscribeForEvent(unsigned subid, EVENT_t event)
     ++it2;
   }
   m_subscriptionsByEvent[event].push_back(subid);
+  m_eventMask |= PROTO_EVENT_MASK(event);
   return true;
 }
 
@@ -285,44 +333,92 @@ void BasicEventHandler::RevokeSubscription(unsigned subid)
   it = m_subscriptions.find(subid);
   if (it != m_subscriptions.end())
   {
-    delete it->second;
+    SubscriptionPtr revoked = it->second;
     m_subscriptions.erase(it);
+    // Don't hold the dispatching while the delivery in progress is finishing
+    lock.Unlock();
+    revoked->Revoke();
   }
 }
 
 void BasicEventHandler::RevokeAllSubscriptions(EventSubscriber *sub)
 {
   OS::CLockGuard lock(m_mutex);
-  std::vector<subscriptions_t::iterator> its;
-  for (subscriptions_t::iterator it = m_subscriptions.begin(); it != m_subscriptions.end(); ++it)
+  std::vector<SubscriptionPtr> revoked;
+  subscriptions_t::iterator it = m_subscriptions.begin();
+  while (it != m_subscriptions.end())
   {
     if (sub == it->second->GetHandle())
-      its.push_back(it);
+    {
+      revoked.push_back(it->second);
+      m_subscriptions.erase(it++);
+    }
+    else
+      ++it;
   }
-  for (std::vector<subscriptions_t::iterator>::const_iterator it = its.begin(); it != its.end(); ++it)
+  // Don't hold the dispatching while the deliveries in progress are finishing
+  lock.Unlock();
+  for (std::vector<SubscriptionPtr>::iterator itr = revoked.begin(); itr != revoked.end(); ++itr)
+    (*itr)->Revoke();
+}
+
+std::string BasicEventHandler::CoalescingKey(const EventMessage& msg)
+{
+  std::string key;
+  switch (msg.event)
   {
-    delete (*it)->second;
-    m_subscriptions.erase(*it);
+    case EVENT_UPDATE_FILE_SIZE:
+      // The recorded key is followed by the file size: recordedid or chanid + starttime
+      for (size_t i = 1; i + 1 < msg.subject.size(); ++i)
+        key.append(msg.subject[i]).append(" ");
+      break;
+    case EVENT_SIGNAL:
+      // The card number
+      if (msg.subject.size() > 1)
+        key = msg.subject[1];
+      break;
+    default:
+      break;
   }
+  return key;
+}
+
+unsigned BasicEventHandler::GetEventMask()
+{
+  OS::CLockGuard lock(m_mutex);
+  return m_eventMask;
 }
 
-void BasicEventHandler::DispatchEvent(const EventMessage& msg)
+void BasicEventHandler::DispatchEvent(const EventMessagePtr& msg)
 {
+  std::string key = CoalescingKey(*msg);
   OS::CLockGuard lock(m_mutex);
   std::vector<std::list<unsigned>::iterator> revoked;
-  std::list<unsigned>::iterator it1 = m_subscriptionsByEvent[msg.event].begin();
-  while (it1 != m_subscriptionsByEvent[msg.event].end())
+  std::list<unsigned>& subids = m_subscriptionsByEvent[msg->event];
+  std::list<unsigned>::iterator it1 = subids.begin();
+  while (it1 != subids.end())
   {
     subscriptions_t::const_iterator it2 = m_subscriptions.find(*it1);
-    if (it2 != m_subscriptions.end())
-      it2->second->PostMessage(msg);
-    else
+    if (it2 == m_subscriptions.end())
       revoked.push_back(it1);
+    else if (it2->second->PostMessage(msg, key))
+    {
+      // The subscription was idle: schedule the delivery of its queue
+      SubscriptionWorker *worker = new SubscriptionWorker(it2->second);
+      if (!m_dispatcher.Enqueue(worker))
+      {
+        DBG(DBG_ERROR, "%s: dispatcher failed (%p:%u)\n", __FUNCTION__, it2->second->GetHandle(), it2->first);
+        worker->Process();
+        delete worker;
+      }
+    }
     ++it1;
   }
   std::vector<std::list<unsigned>::iterator>::const_iterator itr;
   for (itr = revoked.begin(); itr != revoked.end(); ++itr)
-    m_subscriptionsByEvent[msg.event].erase(*itr);
+    subids.erase(*itr);
+  if (subids.empty())
+    m_eventMask &= ~PROTO_EVENT_MASK(msg->event);
 }
 
 void *BasicEventHandler::Process()
@@ -333,10 +429,15 @@ void *BasicEventHandler::Process()
   while (!OS::CThread::IsStopped())
   {
     int r;
-    EventMessage msg;
-    r = m_event->RcvBackendMessage(EVENTHANDLER_TIMEOUT, msg);
+    // The message is shared by all the subscriptions
+    EventMessagePtr msg(new EventMessage());
+    r = m_event->RcvBackendMessage(EVENTHANDLER_TIMEOUT, *msg, this);
     if (r > 0)
-      DispatchEvent(msg);
+    {
+      // The subject is empty when nobody subscribed for the event
+      if (!msg->subject.empty())
+        DispatchEvent(msg);
+    }
     else if (r < 0)
     {
       AnnounceStatus(EVENTHANDLER_DISCONNECTED);
@@ -363,18 +464,18 @@ void *BasicEventHandler::Process()
 void BasicEventHandler::AnnounceStatus(const char *status)
 {
   DBG(DBG_DEBUG, "%s: (%p) %s\n", __FUNCTION__, this, status);
-  EventMessage msg;
-  msg.event = EVENT_HANDLER_STATUS;
-  msg.subject.push_back(status);
-  msg.subject.push_back(m_server);
+  EventMessagePtr msg(new EventMessage());
+  msg->event = EVENT_HANDLER_STATUS;
+  msg->subject.push_back(status);
+  msg->subject.push_back(m_server);
   DispatchEvent(msg);
 }
 
 void BasicEventHandler::AnnounceTimer()
 {
-  EventMessage msg;
-  msg.event = EVENT_HANDLER_TIMER;
-  msg.subject.push_back("");
+  EventMessagePtr msg(new EventMessage());
+  msg->event = EVENT_HANDLER_TIMER;
+  msg->subject.push_back("");
   DispatchEvent(msg);
 }
 
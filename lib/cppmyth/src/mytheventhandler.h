@@ -39,6 +39,7 @@ namespace Myth
   {
   public:
     virtual ~EventSubscriber() {};
+    /// The message is shared by all the subscribers and must not be modified
     virtual void HandleBackendMessage(EventMessagePtr msg) = 0;
   };
 
@@ -56,7 +57,9 @@ namespace Myth
     bool IsConnected() { return m_imp->IsConnected(); }
 
     unsigned CreateSubscription(EventSubscriber *sub) { return m_imp->CreateSubscription(sub); }
-    bool SubscribeForEvent(unsigned subid, EVENT_t event) { return m_imp->SubscribeForEvent(subid, event);}
+    /// With latestOnly a queued message of the event is replaced by a newer one for the same key (recording, card)
+    bool SubscribeForEvent(unsigned subid, EVENT_t event, bool latestOnly = false) { return m_imp->SubscribeForEvent(subid, event, latestOnly);}
+    /// Wait for the delivery in progress, so it must not be called by the subscriber handling it
     void RevokeSubscription(unsigned subid) { m_imp->RevokeSubscription(subid); }
     void RevokeAllSubscriptions(EventSubscriber *sub) { m_imp->RevokeAllSubscriptions(sub); }
 
@@ -74,7 +77,7 @@ namespace Myth
       virtual bool IsRunning() = 0;
       virtual bool IsConnected() = 0;
       virtual unsigned CreateSubscription(EventSubscriber *sub) = 0;
-      virtual bool SubscribeForEvent(unsigned subid, EVENT_t event) = 0;
+      virtual bool SubscribeForEvent(unsigned subid, EVENT_t event, bool latestOnly) = 0;
       virtual void RevokeSubscription(unsigned subid) = 0;
       virtual void RevokeAllSubscriptions(EventSubscriber *sub) = 0;
 
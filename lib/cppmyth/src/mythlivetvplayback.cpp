@@ -54,11 +54,11 @@ LiveTVPlayback::LiveTVPlayback(EventHandler& handler)
 , m_chain()
 {
   m_eventSubscriberId = m_eventHandler.CreateSubscription(this);
-  m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_SIGNAL);
+  m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_SIGNAL, true);
   m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_LIVETV_CHAIN);
   m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_LIVETV_WATCH);
   m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_DONE_RECORDING);
-  m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_UPDATE_FILE_SIZE);
+  m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_UPDATE_FILE_SIZE, true);
   Open();
 }
 
@@ -73,11 +73,11 @@ LiveTVPlayback::LiveTVPlayback(const std::string& server, unsigned port)
 {
   // Private handler will be stopped and closed by destructor.
   m_eventSubscriberId = m_eventHandler.CreateSubscription(this);
-  m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_SIGNAL);
+  m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_SIGNAL, true);
   m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_LIVETV_CHAIN);
   m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_LIVETV_WATCH);
   m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_DONE_RECORDING);
-  m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_UPDATE_FILE_SIZE);
+  m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_UPDATE_FILE_SIZE, true);
   Open();
 }
 
@@ -43,7 +43,7 @@ RecordingPlayback::RecordingPlayback(EventHandler& handler)
 , m_readAhead(false)
 {
   m_eventSubscriberId = m_eventHandler.CreateSubscription(this);
-  m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_UPDATE_FILE_SIZE);
+  m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_UPDATE_FILE_SIZE, true);
   Open();
 }
 
@@ -57,7 +57,7 @@ RecordingPlayback::RecordingPlayback(const std::string& server, unsigned port)
 {
   // Private handler will be stopped and closed by destructor.
   m_eventSubscriberId = m_eventHandler.CreateSubscription(this);
-  m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_UPDATE_FILE_SIZE);
+  m_eventHandler.SubscribeForEvent(m_eventSubscriberId, EVENT_UPDATE_FILE_SIZE, true);
   Open();
 }
 
@@ -0,0 +1,158 @@
+/*
+ *      Copyright (C) 2014 Jean-Luc Barriere
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301 USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "mythsharedstring.h"
+#include "private/os/threads/mutex.h"
+
+#include <cstring>
+
+#define POOL_INITIAL_BUCKETS  256
+
+using namespace Myth;
+
+namespace
+{
+  struct PoolEntry
+  {
+    std::string value;
+    uint32_t hash;
+    PoolEntry *next;
+
+    PoolEntry(const char *str, size_t len, uint32_t h)
+    : value(str, len), hash(h), next(NULL) { }
+  };
+
+  /**
+   * Open hash table of interned strings. Entries are allocated once and never
+   * released, so a pointer to the value stays valid for the process lifetime.
+   */
+  struct Pool
+  {
+    OS::CMutex mutex;
+    PoolEntry **buckets;
+    unsigned bucketCount;
+    unsigned entryCount;
+
+    Pool()
+    : buckets(new PoolEntry*[POOL_INITIAL_BUCKETS])
+    , bucketCount(POOL_INITIAL_BUCKETS)
+    , entryCount(0)
+    {
+      memset(buckets, 0, bucketCount * sizeof(PoolEntry*));
+    }
+
+    void Grow()
+    {
+      unsigned count = bucketCount * 2;
+      PoolEntry **tab = new PoolEntry*[count];
+      memset(tab, 0, count * sizeof(PoolEntry*));
+      for (unsigned i = 0; i < bucketCount; ++i)
+      {
+        PoolEntry *e = buckets[i];
+        while (e != NULL)
+        {
+          PoolEntry *n = e->next;
+          unsigned b = e->hash & (count - 1);
+          e->next = tab[b];
+          tab[b] = e;
+          e = n;
+        }
+      }
+      delete[] buckets;
+      buckets = tab;
+      bucketCount = count;
+    }
+  };
+
+  Pool s_pool;
+
+  inline uint32_t __hash(const char *str, size_t len)
+  {
+    // FNV-1a
+    uint32_t h = 2166136261U;
+    for (size_t i = 0; i < len; ++i)
+    {
+      h ^= (unsigned char)str[i];
+      h *= 16777619U;
+    }
+    return h;
+  }
+}
+
+SharedString::SharedString(const char *str)
+: m_str(NULL)
+{
+  if (str != NULL && *str != '\0')
+    m_str = Intern(str, strlen(str));
+}
+
+const std::string *SharedString::Lookup(const char *str, size_t len, uint32_t h)
+{
+  // The pool must be locked
+  unsigned b = h & (s_pool.bucketCount - 1);
+  for (PoolEntry *e = s_pool.buckets[b]; e != NULL; e = e->next)
+  {
+    if (e->hash == h && e->value.size() == len && memcmp(e->value.data(), str, len) == 0)
+      return &(e->value);
+  }
+  return NULL;
+}
+
+const std::string *SharedString::Intern(const char *str, size_t len)
+{
+  if (len == 0)
+    return NULL;
+  uint32_t h = __hash(str, len);
+  OS::CLockGuard lock(s_pool.mutex);
+  const std::string *value = Lookup(str, len, h);
+  if (value != NULL)
+    return value;
+  unsigned b = h & (s_pool.bucketCount - 1);
+  PoolEntry *e = new PoolEntry(str, len, h);
+  e->next = s_pool.buckets[b];
+  s_pool.buckets[b] = e;
+  if (++s_pool.entryCount > s_pool.bucketCount)
+    s_pool.Grow();
+  return &(e->value);
+}
+
+const std::string& SharedString::Empty()
+{
+  static const std::string empty;
+  return empty;
+}
+
+bool SharedString::Find(const std::string& str, SharedString& found)
+{
+  found.clear();
+  if (str.empty())
+    return true;
+  uint32_t h = __hash(str.c_str(), str.size());
+  OS::CLockGuard lock(s_pool.mutex);
+  found.m_str = Lookup(str.c_str(), str.size(), h);
+  return (found.m_str != NULL);
+}
+
+unsigned SharedString::PoolSize()
+{
+  OS::CLockGuard lock(s_pool.mutex);
+  return s_pool.entryCount;
+}
@@ -0,0 +1,93 @@
+/*
+ *      Copyright (C) 2014 Jean-Luc Barriere
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301 USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#ifndef MYTHSHAREDSTRING_H
+#define	MYTHSHAREDSTRING_H
+
+#include <string>
+#include <cstddef>  // for NULL
+#include <stdint.h>
+
+namespace Myth
+{
+  /**
+   * Immutable string interned into a process wide pool.
+   * It is intended for low-cardinality fields (category, host name, group...)
+   * which are repeated in every program of large lists. All copies share the
+   * same storage and copying is a pointer copy. Pooled values are never freed.
+   */
+  class SharedString
+  {
+  public:
+    SharedString() : m_str(NULL) { }
+    SharedString(const std::string& str) : m_str(Intern(str.c_str(), str.size())) { }
+    SharedString(const char *str);
+    SharedString(const char *str, size_t len) : m_str(Intern(str, len)) { }
+
+    const std::string& str() const
+    {
+      return (m_str != NULL ? *m_str : Empty());
+    }
+
+    operator const std::string&() const { return str(); }
+
+    const char *c_str() const { return str().c_str(); }
+    size_t size() const { return (m_str != NULL ? m_str->size() : 0); }
+    size_t length() const { return size(); }
+    bool empty() const { return (m_str == NULL || m_str->empty()); }
+    void clear() { m_str = NULL; }
+
+    int compare(const std::string& other) const { return str().compare(other); }
+    int compare(const char *other) const { return str().compare(other); }
+
+    /** Two interned strings are equal when they share the same storage */
+    bool operator==(const SharedString& other) const { return m_str == other.m_str; }
+    bool operator!=(const SharedString& other) const { return m_str != other.m_str; }
+    bool operator<(const SharedString& other) const { return str() < other.str(); }
+
+    /**
+     * Return the count of distinct strings held by the pool
+     */
+    static unsigned PoolSize();
+
+    /**
+     * Lookup the string into the pool without adding it
+     * @return false when the string is not interned
+     */
+    static bool Find(const std::string& str, SharedString& found);
+
+  private:
+    const std::string *m_str;
+
+    static const std::string *Intern(const char *str, size_t len);
+    static const std::string *Lookup(const char *str, size_t len, uint32_t h);
+    static const std::string& Empty();
+  };
+
+  inline bool operator==(const SharedString& a, const std::string& b) { return a.str() == b; }
+  inline bool operator==(const std::string& a, const SharedString& b) { return a == b.str(); }
+  inline bool operator==(const SharedString& a, const char *b) { return a.str() == b; }
+  inline bool operator!=(const SharedString& a, const std::string& b) { return a.str() != b; }
+  inline bool operator!=(const std::string& a, const SharedString& b) { return a != b.str(); }
+  inline bool operator!=(const SharedString& a, const char *b) { return a.str() != b; }
+}
+
+#endif	/* MYTHSHAREDSTRING_H */
@@ -24,6 +24,7 @@
 
 #include "mythsharedptr.h"
 #define MYTH_SHARED_PTR Myth::shared_ptr
+#include "mythsharedstring.h"
 
 #include <string>
 #include <stdint.h>
@@ -254,9 +255,9 @@ namespace Myth
   {
     uint32_t            chanId;
     std::string         chanNum;
-    std::string         callSign;
+    SharedString        callSign;
     std::string         iconURL;
-    std::string         channelName;
+    SharedString        channelName;
     uint32_t            mplexId;
     std::string         commFree;
     std::string         chanFilters;
@@ -289,9 +290,9 @@ namespace Myth
     time_t              startTs;
     time_t              endTs;
     std::string         profile;
-    std::string         recGroup;
-    std::string         storageGroup;
-    std::string         playGroup;
+    SharedString        recGroup;
+    SharedString        storageGroup;
+    SharedString        playGroup;
     uint32_t            recordedId; // Since proto 82
 
     Recording()
@@ -321,9 +322,9 @@ namespace Myth
     std::string             description;
     uint16_t                season;
     uint16_t                episode;
-    std::string             category;
-    std::string             catType;
-    std::string             hostName;
+    SharedString            category;
+    SharedString            catType;
+    SharedString            hostName;
     std::string             fileName;
     int64_t                 fileSize;
     bool                    repeat;
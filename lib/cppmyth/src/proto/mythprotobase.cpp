@@ -189,6 +189,23 @@ bool ProtoBase::ReadField(std::string& field)
   return true;
 }
 
+/**
+ * Read one field from the backend response and intern its value
+ * @param field
+ * @return true : false
+ */
+bool ProtoBase::ReadField(SharedString& field)
+{
+  std::string buf;
+  if (!ReadField(buf))
+  {
+    field.clear();
+    return false;
+  }
+  field = SharedString(buf);
+  return true;
+}
+
 bool ProtoBase::IsMessageOK(const std::string& field) const
 {
   if (field.size() == 2)
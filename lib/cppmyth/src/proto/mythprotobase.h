@@ -83,6 +83,7 @@ namespace Myth
     bool SendCommand(const char *cmd, bool feedback = true);
     size_t GetMessageLength() const;
     bool ReadField(std::string& field);
+    bool ReadField(SharedString& field);
     bool IsMessageOK(const std::string& field) const;
     size_t FlushMessage();
     bool RcvMessageLength();
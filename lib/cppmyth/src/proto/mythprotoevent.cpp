@@ -27,6 +27,7 @@
 
 #include <limits>
 #include <cstdio>
+#include <cstring>
 #include <vector>
 
 using namespace Myth;
@@ -128,7 +129,53 @@ SignalStatusPtr ProtoEvent::RcvSignalStatus()
   return signal;
 }
 
-int ProtoEvent::RcvBackendMessage(unsigned timeout, EventMessage& msg)
+/*
+ * Perfect hash of the event names: no two of them share a slot, so a name is
+ * classified with one lookup and one compare.
+ */
+#define EVENT_HASH_SIZE   16
+#define EVENT_HASH(s, l)  (((l) + (unsigned char)(s)[2] + (unsigned char)(s)[(l) - 5]) & (EVENT_HASH_SIZE - 1))
+
+namespace
+{
+  struct EventName
+  {
+    const char *name;
+    EVENT_t event;
+  };
+
+  const EventName eventHashTable[EVENT_HASH_SIZE] = {
+    { "RECORDING_LIST_CHANGE",  EVENT_RECORDING_LIST_CHANGE },  // 0
+    { NULL,                     EVENT_UNKNOWN },
+    { NULL,                     EVENT_UNKNOWN },
+    { "UPDATE_FILE_SIZE",       EVENT_UPDATE_FILE_SIZE },       // 3
+    { "SYSTEM_EVENT",           EVENT_SYSTEM_EVENT },           // 4
+    { "LIVETV_CHAIN",           EVENT_LIVETV_CHAIN },           // 5
+    { "SIGNAL",                 EVENT_SIGNAL },                 // 6
+    { "GENERATED_PIXMAP",       EVENT_GENERATED_PIXMAP },       // 7
+    { NULL,                     EVENT_UNKNOWN },
+    { "LIVETV_WATCH",           EVENT_LIVETV_WATCH },           // 9
+    { "ASK_RECORDING",          EVENT_ASK_RECORDING },          // 10
+    { NULL,                     EVENT_UNKNOWN },
+    { "CLEAR_SETTINGS_CACHE",   EVENT_CLEAR_SETTINGS_CACHE },   // 12
+    { "QUIT_LIVETV",            EVENT_QUIT_LIVETV },            // 13
+    { "DONE_RECORDING",         EVENT_DONE_RECORDING },         // 14
+    { "SCHEDULE_CHANGE",        EVENT_SCHEDULE_CHANGE },        // 15
+  };
+}
+
+EVENT_t ProtoEvent::ClassifyEvent(const char *name, size_t len)
+{
+  // All the known names have 6 chars at least
+  if (len < 6)
+    return EVENT_UNKNOWN;
+  const EventName& entry = eventHashTable[EVENT_HASH(name, len)];
+  if (entry.name && strlen(entry.name) == len && memcmp(entry.name, name, len) == 0)
+    return entry.event;
+  return EVENT_UNKNOWN;
+}
+
+int ProtoEvent::RcvBackendMessage(unsigned timeout, EventMessage& msg, ProtoEventFilter *filter)
 {
   OS::CLockGuard lock(*m_mutex);
   struct timeval tv;
@@ -146,47 +193,37 @@ int ProtoEvent::RcvBackendMessage(unsigned timeout, EventMessage& msg)
     {
       unsigned n = 0;
       ReadField(field);
-      // Tokenize the subject
-      __tokenize(field, " ", msg.subject, false);
-      n = (unsigned)msg.subject.size();
-      DBG(DBG_DEBUG, "%s: %s (%u)\n", __FUNCTION__, field.c_str(), n);
-
-      if (msg.subject[0] == "UPDATE_FILE_SIZE")
-        msg.event = EVENT_UPDATE_FILE_SIZE;
-      else if (msg.subject[0] == "DONE_RECORDING")
-        msg.event = EVENT_DONE_RECORDING;
-      else if (msg.subject[0] == "QUIT_LIVETV")
-        msg.event = EVENT_QUIT_LIVETV;
-      else if (msg.subject[0] == "LIVETV_WATCH")
-        msg.event = EVENT_LIVETV_WATCH;
-      else if (msg.subject[0] == "LIVETV_CHAIN")
-        msg.event = EVENT_LIVETV_CHAIN;
-      else if (msg.subject[0] == "SIGNAL")
-      {
-        msg.event = EVENT_SIGNAL;
-        msg.signal = RcvSignalStatus();
-      }
-      else if (msg.subject[0] == "RECORDING_LIST_CHANGE")
-      {
-        msg.event = EVENT_RECORDING_LIST_CHANGE;
-        if (n > 1 && msg.subject[1] == "UPDATE")
-          msg.program = RcvProgramInfo();
-      }
-      else if (msg.subject[0] == "SCHEDULE_CHANGE")
-        msg.event = EVENT_SCHEDULE_CHANGE;
-      else if (msg.subject[0] == "ASK_RECORDING")
+      // Classify on the first token of the subject
+      std::string::size_type len = field.find(' ');
+      msg.event = ClassifyEvent(field.c_str(), len != std::string::npos ? len : field.size());
+      // Nobody wants the event: it is flushed before tokenizing the subject or
+      // decoding the attached data
+      unsigned eventMask = (filter ? filter->GetEventMask() : PROTO_EVENT_MASK_ALL);
+      if ((eventMask & PROTO_EVENT_MASK(msg.event)) == 0)
+        DBG(DBG_PROTO, "%s: %s (dropped)\n", __FUNCTION__, field.c_str());
+      else
       {
-        msg.event = EVENT_ASK_RECORDING;
-        msg.program = RcvProgramInfo();
+        // Tokenize the subject
+        __tokenize(field, " ", msg.subject, false);
+        n = (unsigned)msg.subject.size();
+        DBG(DBG_DEBUG, "%s: %s (%u)\n", __FUNCTION__, field.c_str(), n);
+
+        switch (msg.event)
+        {
+          case EVENT_SIGNAL:
+            msg.signal = RcvSignalStatus();
+            break;
+          case EVENT_RECORDING_LIST_CHANGE:
+            if (n > 1 && msg.subject[1] == "UPDATE")
+              msg.program = RcvProgramInfo();
+            break;
+          case EVENT_ASK_RECORDING:
+            msg.program = RcvProgramInfo();
+            break;
+          default:
+            break;
+        }
       }
-      else if (msg.subject[0] == "CLEAR_SETTINGS_CACHE")
-        msg.event = EVENT_CLEAR_SETTINGS_CACHE;
-      else if (msg.subject[0] == "GENERATED_PIXMAP")
-        msg.event = EVENT_GENERATED_PIXMAP;
-      else if (msg.subject[0] == "SYSTEM_EVENT")
-        msg.event = EVENT_SYSTEM_EVENT;
-      else
-        msg.event = EVENT_UNKNOWN;
     }
 
     FlushMessage();
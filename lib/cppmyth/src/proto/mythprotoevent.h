@@ -25,10 +25,23 @@
 #include "mythprotobase.h"
 
 #define PROTO_EVENT_RCVBUF        64000
+#define PROTO_EVENT_MASK(e)       (1u << (e))
+#define PROTO_EVENT_MASK_ALL      (~0u)
 
 namespace Myth
 {
 
+  /**
+   * Tells the events to decode. It is asked once the header of a message is
+   * received, so a subscription made while waiting applies to the message.
+   */
+  class ProtoEventFilter
+  {
+  public:
+    virtual ~ProtoEventFilter() {}
+    virtual unsigned GetEventMask() = 0;
+  };
+
   class ProtoEvent : public ProtoBase
   {
   public:
@@ -41,14 +54,16 @@ namespace Myth
      * @brief Wait for new backend message from event connection
      * @param timeout Number of seconds
      * @param msg Handle MythEventMessage
+     * @param filter Events to decode, all when NULL. The subject of a message filtered out is left empty.
      * @return success: 0 = No message, 1 = New message received
      * @return failure: -(errno)
      */
-    int RcvBackendMessage(unsigned timeout, EventMessage& msg);
+    int RcvBackendMessage(unsigned timeout, EventMessage& msg, ProtoEventFilter *filter = NULL);
 
   private:
     bool Announce75();
     SignalStatusPtr RcvSignalStatus();
+    static EVENT_t ClassifyEvent(const char *name, size_t len);
   };
 
 }
@@ -0,0 +1,426 @@
+/*
+ *      Copyright (C) 2005-2014 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301 USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "avinfoCache.h"
+#include "avinfo.h"
+#include "client.h"
+
+#include <mythrecordingplayback.h>
+#include <p8-platform/util/timeutils.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+#define AVINFO_FILENAME       "avinfo.dat"
+#define AVINFO_MAGIC          "MYTHAVINFO"
+#define AVINFO_VERSION        2
+#define AVINFO_BUFFER_SIZE    32000
+
+using namespace ADDON;
+using namespace P8PLATFORM;
+
+AVInfoCache::AVInfoCache(AVInfoConsumer *consumer, Myth::EventHandler& handler, const std::string& serverHostName)
+: CThread()
+, m_consumer(consumer)
+, m_handler(handler)
+, m_serverHostName(serverHostName)
+, m_filePath(g_szUserPath + AVINFO_FILENAME)
+, m_queueContent()
+, m_probed()
+, m_cache()
+, m_modified(false)
+, m_saved(time(NULL))
+, m_paused(false)
+, m_urgent()
+, m_queue()
+, m_pending()
+, m_failed()
+, m_added()
+{
+  Load();
+  CreateThread();
+}
+
+AVInfoCache::~AVInfoCache()
+{
+  StopThread(-1); // Set stopping. don't wait as we need to signal the thread first
+  m_queueContent.Signal();
+  StopThread(); // Wait for thread to stop
+  CLockObject lock(m_lock);
+  if (m_modified)
+    Save();
+}
+
+AVInfoCache::CacheKey AVInfoCache::MakeKey(const MythProgramInfo& programInfo)
+{
+  // Without recorded id (protocol < 82) the recording is known by its file
+  uint32_t recordedId = programInfo.RecordedID();
+  return std::make_pair(recordedId, recordedId ? std::string() : programInfo.FileName());
+}
+
+bool AVInfoCache::IsProbable(const MythProgramInfo& programInfo)
+{
+  // The file of an active recording is still growing
+  switch (programInfo.Status())
+  {
+  case Myth::RS_RECORDING:
+  case Myth::RS_TUNING:
+    return false;
+  default:
+    break;
+  }
+  return programInfo.FileSize() > 0;
+}
+
+bool AVInfoCache::Apply(MythProgramInfo& programInfo) const
+{
+  CLockObject lock(m_lock);
+  CacheMap::const_iterator it = m_cache.find(MakeKey(programInfo));
+  if (it == m_cache.end() || it->second.fileSize != programInfo.FileSize())
+    return false;
+  programInfo.SetPropsVideoFrameRate(it->second.fps);
+  programInfo.SetPropsVideoAspec(it->second.aspec);
+  return true;
+}
+
+void AVInfoCache::Store(const MythProgramInfo& programInfo)
+{
+  if (!IsProbable(programInfo) || programInfo.GetPropsVideoFrameRate() <= 0)
+    return;
+  CacheEntry entry;
+  entry.fileSize = programInfo.FileSize();
+  entry.fps = programInfo.GetPropsVideoFrameRate();
+  entry.aspec = programInfo.GetPropsVideoAspec();
+  CLockObject lock(m_lock);
+  m_cache[MakeKey(programInfo)] = entry;
+  m_modified = true;
+}
+
+void AVInfoCache::Enqueue(MythProgramInfo& programInfo)
+{
+  if (programInfo.GetPropsVideoFrameRate() > 0 || Apply(programInfo))
+    return;
+  // Only the master backend is reachable through the handler
+  if (!IsProbable(programInfo) || programInfo.HostName() != m_serverHostName)
+    return;
+  CacheKey key = MakeKey(programInfo);
+  CLockObject lock(m_lock);
+  if (!m_added.count(key) || m_failed.count(key) || !m_pending.insert(key).second)
+    return;
+  m_queue.push_back(programInfo);
+  m_queueContent.Signal();
+}
+
+void AVInfoCache::Add(MythProgramInfo& programInfo)
+{
+  {
+    CLockObject lock(m_lock);
+    m_added.insert(MakeKey(programInfo));
+  }
+  Enqueue(programInfo);
+}
+
+void AVInfoCache::Prune(const std::set<CacheKey>& keys)
+{
+  CLockObject lock(m_lock);
+  unsigned count = 0;
+  CacheMap::iterator it = m_cache.begin();
+  while (it != m_cache.end())
+  {
+    if (keys.count(it->first))
+      ++it;
+    else
+    {
+      m_cache.erase(it++);
+      ++count;
+    }
+  }
+  if (count > 0)
+  {
+    m_modified = true;
+    XBMC->Log(LOG_DEBUG, "%s: Pruned %u entries", __FUNCTION__, count);
+  }
+}
+
+void AVInfoCache::Request(const MythProgramInfo& programInfo)
+{
+  CacheKey key = MakeKey(programInfo);
+  CLockObject lock(m_lock);
+  if (!m_pending.insert(key).second)
+  {
+    // Take it off the background queue, else it is already on the way
+    std::list<MythProgramInfo>::iterator it = m_queue.begin();
+    while (it != m_queue.end() && MakeKey(*it) != key)
+      ++it;
+    if (it == m_queue.end())
+      return;
+    m_queue.erase(it);
+  }
+  m_urgent.push_back(programInfo);
+  m_queueContent.Signal();
+}
+
+bool AVInfoCache::WaitProbed(const MythProgramInfo& programInfo, unsigned timeout)
+{
+  CacheKey key = MakeKey(programInfo);
+  CTimeout deadline(timeout);
+  for (;;)
+  {
+    {
+      CLockObject lock(m_lock);
+      if (m_pending.count(key) == 0)
+        return true;
+    }
+    uint32_t left = deadline.TimeLeft();
+    if (left == 0)
+      return false;
+    m_probed.Wait(left);
+  }
+}
+
+void AVInfoCache::PauseBackground()
+{
+  CLockObject lock(m_lock);
+  m_paused = true;
+}
+
+void AVInfoCache::ResumeBackground()
+{
+  CLockObject lock(m_lock);
+  m_paused = false;
+  m_queueContent.Signal();
+}
+
+void AVInfoCache::Suspend()
+{
+  if (IsRunning())
+  {
+    XBMC->Log(LOG_DEBUG, "%s: Stopping Thread", __FUNCTION__);
+    StopThread(-1); // Set stopping. don't wait as we need to signal the thread first
+    m_queueContent.Signal();
+    StopThread(); // Wait for thread to stop
+  }
+  CLockObject lock(m_lock);
+  if (m_modified)
+    Save();
+}
+
+void AVInfoCache::Resume()
+{
+  if (IsStopped())
+  {
+    XBMC->Log(LOG_DEBUG, "%s: Resuming Thread", __FUNCTION__);
+    CreateThread();
+  }
+}
+
+bool AVInfoCache::Probe(Myth::Stream *stream, float& fps, float& aspec)
+{
+  AVInfo info(stream);
+  AVInfo::STREAM_AVINFO mInfo;
+  if (!info.GetMainStream(&mInfo))
+    return false;
+  // Video frame rate
+  fps = 0;
+  if (mInfo.stream_info.fps_scale > 0)
+  {
+    switch(mInfo.stream_type)
+    {
+      case TSDemux::STREAM_TYPE_VIDEO_H264:
+        fps = (float)(mInfo.stream_info.fps_rate) / (mInfo.stream_info.fps_scale * (mInfo.stream_info.interlaced ? 2 : 1));
+        break;
+      default:
+        fps = (float)(mInfo.stream_info.fps_rate) / mInfo.stream_info.fps_scale;
+    }
+  }
+  // Video aspec
+  aspec = mInfo.stream_info.aspect;
+  return true;
+}
+
+void *AVInfoCache::Process()
+{
+  XBMC->Log(LOG_DEBUG, "%s: AVInfoCache Thread Started", __FUNCTION__);
+
+  while (!IsStopped())
+  {
+    CLockObject lock(m_lock);
+    if (m_modified && difftime(time(NULL), m_saved) >= c_saveDelay)
+      Save();
+    bool urgent = !m_urgent.empty();
+    if (!urgent && (m_paused || m_queue.empty()))
+    {
+      lock.Unlock();
+      // Wake from time to time to save the entries kept by playback
+      m_queueContent.Wait(c_saveDelay * 1000);
+      continue;
+    }
+    std::list<MythProgramInfo>& queue = (urgent ? m_urgent : m_queue);
+    MythProgramInfo prog(queue.front());
+    queue.pop_front();
+    lock.Unlock();
+
+    float fps = 0, aspec = 0;
+    bool done = false;
+    Myth::RecordingPlayback playback(m_handler);
+    if (playback.IsOpen() && playback.OpenTransfer(prog.GetPtr()))
+    {
+      done = Probe(&playback, fps, aspec) && fps > 0;
+      playback.Close();
+    }
+
+    lock.Lock();
+    CacheKey key = MakeKey(prog);
+    m_pending.erase(key);
+    if (done && IsProbable(prog))
+    {
+      CacheEntry entry;
+      entry.fileSize = prog.FileSize();
+      entry.fps = fps;
+      entry.aspec = aspec;
+      m_cache[key] = entry;
+      m_modified = true;
+    }
+    else if (!done)
+      m_failed.insert(key);
+    lock.Unlock();
+
+    if (done)
+    {
+      if (g_bExtraDebug)
+        XBMC->Log(LOG_DEBUG, "%s: Probed %s: fps %.3f, aspec %.3f", __FUNCTION__, prog.UID().c_str(), fps, aspec);
+      m_consumer->HandleAVInfoProbed(prog, fps, aspec);
+    }
+    else
+      XBMC->Log(LOG_DEBUG, "%s: Failed to probe %s", __FUNCTION__, prog.UID().c_str());
+    m_probed.Broadcast();
+
+    // Leave the backend alone for a while, unless playback is waiting
+    if (!urgent)
+      m_queueContent.Wait(c_probeDelay);
+  }
+
+  XBMC->Log(LOG_DEBUG, "%s: AVInfoCache Thread Stopped", __FUNCTION__);
+  return NULL;
+}
+
+void AVInfoCache::Load()
+{
+  if (!XBMC->FileExists(m_filePath.c_str(), false))
+    return;
+  void *file = XBMC->OpenFile(m_filePath.c_str(), 0);
+  if (!file)
+  {
+    XBMC->Log(LOG_ERROR, "%s: Failed to open cache %s", __FUNCTION__, m_filePath.c_str());
+    return;
+  }
+  std::string buf;
+  char *chunk = new char[AVINFO_BUFFER_SIZE];
+  ssize_t s;
+  while ((s = XBMC->ReadFile(file, chunk, AVINFO_BUFFER_SIZE)) > 0)
+    buf.append(chunk, (size_t)s);
+  delete[] chunk;
+  XBMC->CloseFile(file);
+
+  // Text lines: header "MYTHAVINFO <version> <backend>", then
+  // "<recordedid> <filesize> <fps> <aspec> <filename>" per entry. The fps and
+  // aspec are stored as thousandths, so the format doesn't depend on the locale.
+  size_t pos = 0;
+  bool header = true;
+  while (pos < buf.size())
+  {
+    size_t eol = buf.find('\n', pos);
+    if (eol == std::string::npos)
+      eol = buf.size();
+    std::string line(buf, pos, eol - pos);
+    pos = eol + 1;
+    if (header)
+    {
+      char magic[16];
+      int version = 0, n = 0;
+      if (sscanf(line.c_str(), "%15s %d %n", magic, &version, &n) < 2 || std::string(magic) != AVINFO_MAGIC ||
+              version != AVINFO_VERSION || line.compare(n, std::string::npos, m_serverHostName) != 0)
+      {
+        XBMC->Log(LOG_NOTICE, "%s: Cache belongs to another backend or has unknown format", __FUNCTION__);
+        return;
+      }
+      header = false;
+      continue;
+    }
+    unsigned long recordedId = 0;
+    long long fileSize = 0;
+    long fps = 0, aspec = 0;
+    int n = 0;
+    if (sscanf(line.c_str(), "%lu %lld %ld %ld %n", &recordedId, &fileSize, &fps, &aspec, &n) < 4)
+      continue;
+    CacheEntry entry;
+    entry.fileSize = (int64_t)fileSize;
+    entry.fps = (float)fps / 1000;
+    entry.aspec = (float)aspec / 1000;
+    m_cache[std::make_pair((uint32_t)recordedId, recordedId ? std::string() : line.substr(n))] = entry;
+  }
+  XBMC->Log(LOG_DEBUG, "%s: Loaded %u entries", __FUNCTION__, (unsigned)m_cache.size());
+}
+
+bool AVInfoCache::Save()
+{
+  // Keep the next attempt for later, even on failure
+  m_saved = time(NULL);
+  std::string buf;
+  char line[64];
+  snprintf(line, sizeof(line), "%s %d ", AVINFO_MAGIC, AVINFO_VERSION);
+  buf.append(line).append(m_serverHostName).append("\n");
+  for (CacheMap::const_iterator it = m_cache.begin(); it != m_cache.end(); ++it)
+  {
+    snprintf(line, sizeof(line), "%lu %lld %ld %ld ", (unsigned long)it->first.first,
+            (long long)it->second.fileSize, (long)(it->second.fps * 1000 + 0.5f), (long)(it->second.aspec * 1000 + 0.5f));
+    buf.append(line).append(it->first.second).append("\n");
+  }
+
+  void *file = XBMC->OpenFileForWrite(m_filePath.c_str(), true);
+  if (!file)
+  {
+    XBMC->Log(LOG_ERROR, "%s: Failed to create cache %s", __FUNCTION__, m_filePath.c_str());
+    return false;
+  }
+  const char *p = buf.data();
+  size_t s = buf.size();
+  while (s > 0)
+  {
+    ssize_t bw = XBMC->WriteFile(file, p, s);
+    if (bw <= 0)
+      break;
+    s -= (size_t)bw;
+    p += bw;
+  }
+  XBMC->CloseFile(file);
+  if (s > 0)
+  {
+    XBMC->Log(LOG_ERROR, "%s: Failed to write cache %s", __FUNCTION__, m_filePath.c_str());
+    XBMC->DeleteFile(m_filePath.c_str());
+    return false;
+  }
+  m_modified = false;
+  XBMC->Log(LOG_DEBUG, "%s: Saved %u entries", __FUNCTION__, (unsigned)m_cache.size());
+  return true;
+}
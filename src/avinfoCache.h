@@ -0,0 +1,120 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2014 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301 USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "cppmyth/MythProgramInfo.h"
+
+#include <mythstream.h>
+#include <mytheventhandler.h>
+#include <p8-platform/threads/threads.h>
+
+#include <string>
+#include <list>
+#include <map>
+#include <set>
+
+class AVInfoConsumer
+{
+public:
+  virtual ~AVInfoConsumer() {};
+  virtual void HandleAVInfoProbed(const MythProgramInfo& programInfo, float fps, float aspec) = 0;
+};
+
+/**
+ * Persistent cache of the AV properties (video frame rate and aspect) of the
+ * recordings, stored in the user path. An entry is bound to the recorded id,
+ * or to the file name on protocol < 82, and to the file size at probe time.
+ * Missing entries of the recordings added during the session are filled by a
+ * low priority prober, which reads the head of the recording through its own
+ * playback connection and transfer. A recording about to be played is probed
+ * first, concurrently with playback, while the background probing is paused.
+ */
+class AVInfoCache : public P8PLATFORM::CThread
+{
+public:
+  static const int c_probeDelay   = 2000;   // Pause 2s between probes to stay low priority
+  static const int c_saveDelay    = 60;     // Save the modified cache at most every 60s
+
+  typedef std::pair<uint32_t, std::string> CacheKey;  ///< recorded id or file name
+  static CacheKey MakeKey(const MythProgramInfo& programInfo);
+
+  AVInfoCache(AVInfoConsumer *consumer, Myth::EventHandler& handler, const std::string& serverHostName);
+  virtual ~AVInfoCache();
+
+  /// Set props of programInfo from cache. Returns false when not cached.
+  bool Apply(MythProgramInfo& programInfo) const;
+  /// Keep props of programInfo once probed by playback
+  void Store(const MythProgramInfo& programInfo);
+  /// Queue programInfo for probing when its props are unknown and not cached, if added during the session
+  void Enqueue(MythProgramInfo& programInfo);
+  /// Mark programInfo as added during the session, then queue it
+  void Add(MythProgramInfo& programInfo);
+  /// Drop the entries of the recordings not in keys
+  void Prune(const std::set<CacheKey>& keys);
+  /// Probe programInfo before anything else, even if background probing is paused
+  void Request(const MythProgramInfo& programInfo);
+  /// Wait until the pending probe of programInfo is done. Returns false on timeout.
+  bool WaitProbed(const MythProgramInfo& programInfo, unsigned timeout);
+
+  void PauseBackground();
+  void ResumeBackground();
+  void Suspend();
+  void Resume();
+
+  /// Probe the main stream of an opened stream. Returns false when not found.
+  static bool Probe(Myth::Stream *stream, float& fps, float& aspec);
+
+protected:
+  void *Process();
+
+private:
+  struct CacheEntry
+  {
+    int64_t fileSize;
+    float fps;
+    float aspec;
+  };
+  typedef std::map<CacheKey, CacheEntry> CacheMap;
+
+  static bool IsProbable(const MythProgramInfo& programInfo);
+
+  void Load();
+  bool Save();
+
+  AVInfoConsumer *m_consumer;
+  Myth::EventHandler& m_handler;
+  std::string m_serverHostName;
+  std::string m_filePath;
+
+  mutable P8PLATFORM::CMutex m_lock;
+  P8PLATFORM::CEvent m_queueContent;
+  P8PLATFORM::CEvent m_probed;
+  CacheMap m_cache;
+  bool m_modified;
+  time_t m_saved;
+  bool m_paused;
+  std::list<MythProgramInfo> m_urgent;
+  std::list<MythProgramInfo> m_queue;
+  std::set<CacheKey> m_pending;       ///< Queued or being probed
+  std::set<CacheKey> m_failed;        ///< Not probed again in background during the session
+  std::set<CacheKey> m_added;         ///< Added during the session, the others are never probed in background
+};
@@ -29,19 +29,50 @@
 
 using namespace ADDON;
 
+static inline size_t __ptrhash(const std::string *p)
+{
+  uint64_t h = (uint64_t)(uintptr_t)p;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return (size_t)h;
+}
+
 Categories::Categories()
 : m_categoriesById()
+, m_nameTable()
+, m_nameMask(0)
 {
   std::string filePath;
   filePath = g_szClientPath + PATH_SEPARATOR_STRING + "resources" + PATH_SEPARATOR_STRING + CATEGORIES_FILENAME;
   LoadEITCategories(filePath.c_str());
   filePath = g_szUserPath + CATEGORIES_FILENAME;
   LoadEITCategories(filePath.c_str());
-  // Copy over
+  BuildNameTable();
+}
+
+void Categories::BuildNameTable()
+{
+  // Size the table to keep the load factor under 0.5
+  size_t size = 16;
+  while (size < m_categoriesById.size() * 2)
+    size <<= 1;
+  NameSlot empty = { NULL, 0 };
+  m_nameTable.assign(size, empty);
+  m_nameMask = size - 1;
+
+  // Copy over. Names are interned so their identity becomes the key
   CategoryByIdMap::const_iterator it;
   for (it = m_categoriesById.begin(); it != m_categoriesById.end(); ++it)
   {
-    m_categoriesByName[it->second] = it->first;
+    if (it->second.empty())
+      continue;
+    const std::string *name = &(Myth::SharedString(it->second).str());
+    size_t i = __ptrhash(name) & m_nameMask;
+    while (m_nameTable[i].name != NULL && m_nameTable[i].name != name)
+      i = (i + 1) & m_nameMask;
+    m_nameTable[i].name = name;
+    m_nameTable[i].category = it->first;
   }
 }
 
@@ -55,9 +86,33 @@ std::string Categories::Category(int category) const
 
 int Categories::Category(const std::string& category) const
 {
-  CategoryByNameMap::const_iterator it = m_categoriesByName.find(category);
-  if (it != m_categoriesByName.end())
-    return it->second;
+  // Don't grow the pool with the strings to look up
+  Myth::SharedString shared;
+  if (Myth::SharedString::Find(category, shared))
+    return Category(shared);
+  // As in the table, the last id of a name wins
+  int ret = 0;
+  CategoryByIdMap::const_iterator it;
+  for (it = m_categoriesById.begin(); it != m_categoriesById.end(); ++it)
+  {
+    if (it->second == category)
+      ret = it->first;
+  }
+  return ret;
+}
+
+int Categories::Category(const Myth::SharedString& category) const
+{
+  if (category.empty())
+    return 0;
+  const std::string *name = &(category.str());
+  size_t i = __ptrhash(name) & m_nameMask;
+  while (m_nameTable[i].name != NULL)
+  {
+    if (m_nameTable[i].name == name)
+      return m_nameTable[i].category;
+    i = (i + 1) & m_nameMask;
+  }
   return 0;
 }
 
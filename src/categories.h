@@ -21,11 +21,13 @@
  *
  */
 
+#include <mythsharedstring.h>
+
 #include <string>
 #include <map>
+#include <vector>
 
 typedef std::multimap<int, std::string> CategoryByIdMap;
-typedef std::map<std::string, int> CategoryByNameMap;
 
 class Categories
 {
@@ -34,10 +36,21 @@ public:
 
   std::string Category(int category) const;
   int Category(const std::string& category) const;
+  /// Lookup by identity of the interned name: no string comparison is done
+  int Category(const Myth::SharedString& category) const;
 
 private:
   void LoadEITCategories(const char *filePath);
+  void BuildNameTable();
 
   CategoryByIdMap   m_categoriesById;
-  CategoryByNameMap m_categoriesByName;
+
+  /// Open addressing table of genre ids keyed by the interned category name
+  struct NameSlot
+  {
+    const std::string *name;
+    int category;
+  };
+  std::vector<NameSlot> m_nameTable;
+  size_t m_nameMask;
 };
@@ -44,6 +44,7 @@ bool          g_bLiveTVPriority         = DEFAULT_LIVETV_PRIORITY;          ///<
 int           g_iLiveTVConflictStrategy = DEFAULT_LIVETV_CONFLICT_STRATEGY; ///< Conflict resolving strategy (0=
 bool          g_bChannelIcons           = DEFAULT_CHANNEL_ICONS;            ///< Load Channel Icons
 bool          g_bRecordingIcons         = DEFAULT_RECORDING_ICONS;          ///< Load Recording Icons (Fanart/Thumbnails)
+int           g_iArtworkCacheSize       = DEFAULT_ARTWORK_CACHE_SIZE;       ///< Disk budget of the artwork cache in MB
 bool          g_bLiveTVRecordings       = DEFAULT_LIVETV_RECORDINGS;        ///< Show LiveTV recordings
 int           g_iRecTemplateType        = DEFAULT_RECORD_TEMPLATE;          ///< Template type for new record (0=Internal, 1=MythTV)
 bool          g_bRecAutoMetadata        = true;
@@ -56,9 +57,12 @@ bool          g_bRecAutoRunJob4         = false;
 bool          g_bRecAutoExpire          = false;
 int           g_iRecTranscoder          = 0;
 int           g_iTuneDelay              = DEFAULT_TUNE_DELAY;
+int           g_iScheduleQuietPeriod    = DEFAULT_SCHEDULE_QUIET_PERIOD;
+int           g_iScheduleMaxDelay       = DEFAULT_SCHEDULE_MAX_DELAY;
 int           g_iGroupRecordings        = GROUP_RECORDINGS_ALWAYS;
 bool          g_bUseAirdate             = DEFAULT_USE_AIRDATE;
 int           g_iEnableEDL              = ENABLE_EDL_ALWAYS;
+bool          g_bPrefetchEDL            = DEFAULT_PREFETCH_EDL;
 bool          g_bBlockMythShutdown      = DEFAULT_BLOCK_SHUTDOWN;
 bool          g_bLimitTuneAttempts      = DEFAULT_LIMIT_TUNE_ATTEMPTS;
 bool          g_bShowNotRecording       = DEFAULT_SHOW_NOT_RECORDING;
@@ -251,6 +255,22 @@ ADDON_STATUS ADDON_Create(void *hdl, void *props)
     g_iTuneDelay = DEFAULT_TUNE_DELAY;
   }
 
+  /* Read setting "schedule_quiet_period" from settings.xml */
+  if (!XBMC->GetSetting("schedule_quiet_period", &g_iScheduleQuietPeriod))
+  {
+    /* If setting is unknown fallback to defaults */
+    XBMC->Log(LOG_ERROR, "Couldn't get 'schedule_quiet_period' setting, falling back to '%d' as default", DEFAULT_SCHEDULE_QUIET_PERIOD);
+    g_iScheduleQuietPeriod = DEFAULT_SCHEDULE_QUIET_PERIOD;
+  }
+
+  /* Read setting "schedule_max_delay" from settings.xml */
+  if (!XBMC->GetSetting("schedule_max_delay", &g_iScheduleMaxDelay))
+  {
+    /* If setting is unknown fallback to defaults */
+    XBMC->Log(LOG_ERROR, "Couldn't get 'schedule_max_delay' setting, falling back to '%d' as default", DEFAULT_SCHEDULE_MAX_DELAY);
+    g_iScheduleMaxDelay = DEFAULT_SCHEDULE_MAX_DELAY;
+  }
+
   /* Read setting "host_ether" from settings.xml */
   if (XBMC->GetSetting("host_ether", buffer))
     g_szMythHostEther = buffer;
@@ -285,6 +305,14 @@ ADDON_STATUS ADDON_Create(void *hdl, void *props)
     g_iEnableEDL = ENABLE_EDL_ALWAYS;
   }
 
+  /* Read setting "prefetch_edl" from settings.xml */
+  if (!XBMC->GetSetting("prefetch_edl", &g_bPrefetchEDL))
+  {
+    /* If setting is unknown fallback to defaults */
+    XBMC->Log(LOG_ERROR, "Couldn't get 'prefetch_edl' setting, falling back to '%u' as default", DEFAULT_PREFETCH_EDL);
+    g_bPrefetchEDL = DEFAULT_PREFETCH_EDL;
+  }
+
   /* Read setting "block_shutdown" from settings.xml */
   if (!XBMC->GetSetting("block_shutdown", &g_bBlockMythShutdown))
   {
@@ -309,6 +337,14 @@ ADDON_STATUS ADDON_Create(void *hdl, void *props)
     g_bRecordingIcons = DEFAULT_RECORDING_ICONS;
   }
 
+  /* Read setting "artwork_cache_size" from settings.xml */
+  if (!XBMC->GetSetting("artwork_cache_size", &g_iArtworkCacheSize))
+  {
+    /* If setting is unknown fallback to defaults */
+    XBMC->Log(LOG_ERROR, "Couldn't get 'artwork_cache_size' setting, falling back to '%d' as default", DEFAULT_ARTWORK_CACHE_SIZE);
+    g_iArtworkCacheSize = DEFAULT_ARTWORK_CACHE_SIZE;
+  }
+
   /* Read setting "limit_tune_attempts" from settings.xml */
   if (!XBMC->GetSetting("limit_tune_attempts", &g_bLimitTuneAttempts))
   {
@@ -500,6 +536,12 @@ ADDON_STATUS ADDON_SetSetting(const char *settingName, const void *settingValue)
     if (g_bRecordingIcons != *(bool*)settingValue)
       return ADDON_STATUS_NEED_RESTART;
   }
+  else if (str == "artwork_cache_size")
+  {
+    XBMC->Log(LOG_INFO, "Changed Setting 'artwork_cache_size' from %d to %d", g_iArtworkCacheSize, *(int*)settingValue);
+    if (g_iArtworkCacheSize != *(int*)settingValue)
+      g_iArtworkCacheSize = *(int*)settingValue;
+  }
   else if (str == "host_ether")
   {
     XBMC->Log(LOG_INFO, "Changed Setting 'host_ether' from %s to %s", g_szMythHostEther.c_str(), (const char*)settingValue);
@@ -597,6 +639,18 @@ ADDON_STATUS ADDON_SetSetting(const char *settingName, const void *settingValue)
     if (g_iTuneDelay != *(int*)settingValue)
       g_iTuneDelay = *(int*)settingValue;
   }
+  else if (str == "schedule_quiet_period")
+  {
+    XBMC->Log(LOG_INFO, "Changed Setting 'schedule_quiet_period' from %d to %d", g_iScheduleQuietPeriod, *(int*)settingValue);
+    if (g_iScheduleQuietPeriod != *(int*)settingValue)
+      g_iScheduleQuietPeriod = *(int*)settingValue;
+  }
+  else if (str == "schedule_max_delay")
+  {
+    XBMC->Log(LOG_INFO, "Changed Setting 'schedule_max_delay' from %d to %d", g_iScheduleMaxDelay, *(int*)settingValue);
+    if (g_iScheduleMaxDelay != *(int*)settingValue)
+      g_iScheduleMaxDelay = *(int*)settingValue;
+  }
   else if (str == "group_recordings")
   {
     XBMC->Log(LOG_INFO, "Changed Setting 'group_recordings' from %u to %u", g_iGroupRecordings, *(int*)settingValue);
@@ -621,6 +675,12 @@ ADDON_STATUS ADDON_SetSetting(const char *settingName, const void *settingValue)
     if (g_iEnableEDL != *(int*)settingValue)
       g_iEnableEDL = *(int*)settingValue;
   }
+  else if (str == "prefetch_edl")
+  {
+    XBMC->Log(LOG_INFO, "Changed Setting 'prefetch_edl' from %u to %u", g_bPrefetchEDL, *(bool*)settingValue);
+    if (g_bPrefetchEDL != *(bool*)settingValue)
+      g_bPrefetchEDL = *(bool*)settingValue;
+  }
   else if (str == "block_shutdown")
   {
     XBMC->Log(LOG_INFO, "Changed Setting 'block_shutdown' from %u to %u", g_bBlockMythShutdown, *(bool*)settingValue);
@@ -44,6 +44,7 @@
 #define DEFAULT_WSAPI_SECURITY_PIN          "0000"
 #define DEFAULT_CHANNEL_ICONS               true
 #define DEFAULT_RECORDING_ICONS             true
+#define DEFAULT_ARTWORK_CACHE_SIZE          500
 #define DEFAULT_RECORD_TEMPLATE             1
 
 #define MENUHOOK_REC_DELETE_AND_RERECORD    1
@@ -54,6 +55,8 @@
 #define MENUHOOK_TRIGGER_CHANNEL_UPDATE     6
 
 #define DEFAULT_TUNE_DELAY                  5
+#define DEFAULT_SCHEDULE_QUIET_PERIOD       2
+#define DEFAULT_SCHEDULE_MAX_DELAY          20
 #define GROUP_RECORDINGS_ALWAYS             0
 #define GROUP_RECORDINGS_ONLY_FOR_SERIES    1
 #define GROUP_RECORDINGS_NEVER              2
@@ -61,6 +64,7 @@
 #define ENABLE_EDL_ALWAYS                   0
 #define ENABLE_EDL_DIALOG                   1
 #define ENABLE_EDL_NEVER                    2
+#define DEFAULT_PREFETCH_EDL                false
 #define DEFAULT_BLOCK_SHUTDOWN              true
 #define DEFAULT_LIMIT_TUNE_ATTEMPTS         true
 #define DEFAULT_SHOW_NOT_RECORDING          true
@@ -95,6 +99,7 @@ extern bool         g_bLiveTVPriority;          ///< MythTV Backend setting to a
 extern int          g_iLiveTVConflictStrategy;  ///< Live TV conflict resolving strategy (0=Has later, 1=Stop TV, 2=Cancel recording)
 extern bool         g_bChannelIcons;            ///< Load Channel Icons
 extern bool         g_bRecordingIcons;          ///< Load Recording Icons (Fanart/Thumbnails)
+extern int          g_iArtworkCacheSize;        ///< Disk budget of the artwork cache in MB
 extern bool         g_bLiveTVRecordings;        ///< Show LiveTV recordings
 extern int          g_iRecTemplateType;         ///< Template type for new record (0=Internal, 1=MythTV)
 ///@{
@@ -110,9 +115,12 @@ extern bool         g_bRecAutoExpire;
 extern int          g_iRecTranscoder;
 ///@}
 extern int          g_iTuneDelay;
+extern int          g_iScheduleQuietPeriod;     ///< Seconds without schedule change before reloading
+extern int          g_iScheduleMaxDelay;        ///< Maximum seconds to delay a schedule reload
 extern int          g_iGroupRecordings;
 extern bool         g_bUseAirdate;
 extern int          g_iEnableEDL;
+extern bool         g_bPrefetchEDL;
 extern bool         g_bBlockMythShutdown;
 extern bool         g_bLimitTuneAttempts;       ///< Limit channel tuning attempts to first card
 extern bool         g_bShowNotRecording;
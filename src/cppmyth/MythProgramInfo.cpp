@@ -21,6 +21,7 @@
 #include "MythProgramInfo.h"
 
 #include <cstdio> // for sprintf
+#include <cstdlib> // for strtoul
 #include <time.h> // for difftime
 
 enum
@@ -37,14 +38,18 @@ enum
 MythProgramInfo::MythProgramInfo()
 : m_proginfo()
 , m_flags(0)
+, m_uid()
 , m_props(new Props())
+, m_cache()
 {
 }
 
 MythProgramInfo::MythProgramInfo(Myth::ProgramPtr proginfo)
 : m_proginfo()
 , m_flags(0)
+, m_uid()
 , m_props(new Props())
+, m_cache()
 {
   m_proginfo.swap(proginfo);
 }
@@ -77,6 +82,21 @@ bool MythProgramInfo::operator !=(const MythProgramInfo &other)
   return !(*this == other);
 }
 
+bool MythProgramInfo::IsSameRevision(const MythProgramInfo &other) const
+{
+  if (IsNull() || other.IsNull())
+    return false;
+  const Myth::Program& a = *m_proginfo;
+  const Myth::Program& b = *(other.m_proginfo);
+  return (a.lastModified == b.lastModified &&
+          a.fileSize == b.fileSize &&
+          a.programFlags == b.programFlags &&
+          a.endTime == b.endTime &&
+          a.recording.status == b.recording.status &&
+          a.recording.endTs == b.recording.endTs &&
+          a.recording.recGroup == b.recording.recGroup);
+}
+
 bool MythProgramInfo::IsSetup() const
 {
   if (m_flags)
@@ -183,14 +203,42 @@ bool MythProgramInfo::GetPropsSerie() const
   return m_props->m_serie;
 }
 
-std::string MythProgramInfo::UID() const
+bool MythProgramKey::FromUID(const char *uid, MythProgramKey& key)
+{
+  char *end;
+  unsigned long chanid = strtoul(uid, &end, 10);
+  if (end == uid || *end != '_')
+    return false;
+  const char *p = end + 1;
+  long startts = strtol(p, &end, 10);
+  if (end == p || *end != '_')
+    return false;
+  p = end + 1;
+  unsigned long recordedid = strtoul(p, &end, 16);
+  if (end == p || *end != '\0')
+    return false;
+  key = MythProgramKey((uint32_t)chanid, (time_t)startts, (uint32_t)recordedid);
+  return true;
+}
+
+MythProgramKey MythProgramInfo::Key() const
 {
-  char buf[48] = "";
-  sprintf(buf, "%u_%ld_%.3x",
-          (unsigned)m_proginfo->channel.chanId,
-          (long)m_proginfo->recording.startTs,
-          (unsigned)m_proginfo->recording.recordedId & 0xfff);
-  return std::string(buf);
+  return MythProgramKey(m_proginfo->channel.chanId, m_proginfo->recording.startTs, m_proginfo->recording.recordedId);
+}
+
+const std::string& MythProgramInfo::UID() const
+{
+  // Identity fields never change for a given entry, so format it once
+  if (m_uid.empty())
+  {
+    char buf[48] = "";
+    sprintf(buf, "%u_%ld_%.3x",
+            (unsigned)m_proginfo->channel.chanId,
+            (long)m_proginfo->recording.startTs,
+            (unsigned)m_proginfo->recording.recordedId & 0xfff);
+    m_uid.assign(buf);
+  }
+  return m_uid;
 }
 
 std::string MythProgramInfo::ProgramID() const
@@ -223,6 +271,11 @@ std::string MythProgramInfo::FileName() const
   return (m_proginfo ? m_proginfo->fileName : "");
 }
 
+int64_t MythProgramInfo::FileSize() const
+{
+  return (m_proginfo ? m_proginfo->fileSize : 0);
+}
+
 std::string MythProgramInfo::Description() const
 {
   return (m_proginfo ? m_proginfo->description : "");
@@ -233,9 +286,9 @@ int MythProgramInfo::Duration() const
   return (m_proginfo ? (int)difftime(m_proginfo->recording.endTs, m_proginfo->recording.startTs) : 0);
 }
 
-std::string MythProgramInfo::Category() const
+Myth::SharedString MythProgramInfo::Category() const
 {
-  return (m_proginfo ? m_proginfo->category : "");
+  return (m_proginfo ? m_proginfo->category : Myth::SharedString());
 }
 
 time_t MythProgramInfo::StartTime() const
@@ -294,6 +347,11 @@ uint32_t MythProgramInfo::RecordID() const
   return (m_proginfo ? m_proginfo->recording.recordId : 0);
 }
 
+uint32_t MythProgramInfo::RecordedID() const
+{
+  return (m_proginfo ? m_proginfo->recording.recordedId : 0);
+}
+
 time_t MythProgramInfo::RecordingStartTime() const
 {
   return (m_proginfo ? m_proginfo->recording.startTs : (time_t)(-1));
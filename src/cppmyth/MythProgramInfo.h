@@ -21,8 +21,42 @@
 
 #include <mythtypes.h>
 
+#include <unordered_map>
+
+/// Numeric identity of a recording, the fields formatted by MythProgramInfo::UID()
+struct MythProgramKey
+{
+  uint32_t chanId;
+  time_t startTs;
+  uint32_t recordedId;    ///< Only the low 12 bits are significant
+
+  MythProgramKey() : chanId(0), startTs(0), recordedId(0) {}
+  MythProgramKey(uint32_t chanid, time_t startts, uint32_t recordedid)
+  : chanId(chanid), startTs(startts), recordedId(recordedid & 0xfff) {}
+
+  bool operator==(const MythProgramKey& other) const
+  {
+    return chanId == other.chanId && startTs == other.startTs && recordedId == other.recordedId;
+  }
+
+  /// Parse an UID string. Returns false if it is malformed.
+  static bool FromUID(const char *uid, MythProgramKey& key);
+};
+
+struct MythProgramKeyHash
+{
+  size_t operator()(const MythProgramKey& key) const
+  {
+    uint64_t h = ((uint64_t)key.chanId << 32) ^ (uint64_t)key.startTs ^ ((uint64_t)key.recordedId << 52);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (size_t)h;
+  }
+};
+
 class MythProgramInfo;
-typedef std::map<std::string, MythProgramInfo> ProgramInfoMap;
+typedef std::unordered_map<MythProgramKey, MythProgramInfo, MythProgramKeyHash> ProgramInfoMap;
 
 class MythProgramInfo
 {
@@ -35,9 +69,11 @@ public:
   Myth::ProgramPtr GetPtr() const;
   bool operator ==(const MythProgramInfo &other);
   bool operator !=(const MythProgramInfo &other);
+  /// True when other holds the same revision of this recording
+  bool IsSameRevision(const MythProgramInfo &other) const;
 
   /// Reset custom flags and properties
-  void ResetProps() {  m_flags = 0; m_props.reset(new Props()); }
+  void ResetProps() {  m_flags = 0; m_props.reset(new Props()); m_cache.reset(); }
   /// Copy reference of properties from other
   void CopyProps(const MythProgramInfo &other) { m_props = other.m_props; }
   // Custom flags
@@ -46,6 +82,15 @@ public:
   bool IsLiveTV() const;
   bool HasCoverart() const;
   bool HasFanart() const;
+  /// Data built by the client from this entry. Unlike props, it is dropped when the entry is replaced.
+  class Cache
+  {
+  public:
+    virtual ~Cache() {}
+  };
+  typedef MYTH_SHARED_PTR<Cache> CachePtr;
+  void SetCache(Cache *cache) const { m_cache.reset(cache); }
+  const CachePtr& GetCache() const { return m_cache; }
   // Custom props
   void SetPropsVideoFrameRate(float fps);
   float GetPropsVideoFrameRate() const;
@@ -54,16 +99,18 @@ public:
   void SetPropsSerie(bool flag);
   bool GetPropsSerie() const;
   // Program fields
-  std::string UID() const;
+  MythProgramKey Key() const;
+  const std::string& UID() const;
   std::string ProgramID() const;
   std::string SerieID() const;
   std::string Title() const;
   std::string Subtitle() const;
   std::string HostName() const;
   std::string FileName() const;
+  int64_t FileSize() const;
   std::string Description() const;
   int Duration() const;
-  std::string Category() const;
+  Myth::SharedString Category() const;
   time_t StartTime() const;
   time_t EndTime() const;
   bool IsWatched() const;
@@ -75,6 +122,7 @@ public:
   Myth::RS_t Status() const;
   std::string RecordingGroup() const;
   uint32_t RecordID() const;
+  uint32_t RecordedID() const;
   time_t RecordingStartTime() const;
   time_t RecordingEndTime() const;
   int Priority() const;
@@ -87,6 +135,7 @@ public:
 private:
   Myth::ProgramPtr m_proginfo;
   mutable int32_t m_flags;
+  mutable std::string m_uid;
 
   class Props
   {
@@ -103,6 +152,7 @@ private:
     bool m_serie;               ///< true if program is serie else false
   };
   MYTH_SHARED_PTR<Props> m_props;
+  mutable CachePtr m_cache;
 
   bool IsSetup() const;
 };
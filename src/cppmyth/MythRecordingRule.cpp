@@ -44,6 +44,60 @@ MythRecordingRule MythRecordingRule::DuplicateRecordingRule() const
   return MythRecordingRule(copy);
 }
 
+bool MythRecordingRule::IsSameRevision(const MythRecordingRule& other) const
+{
+  if (m_recordSchedule.get() == other.m_recordSchedule.get())
+    return true;
+  const Myth::RecordSchedule& a = *m_recordSchedule;
+  const Myth::RecordSchedule& b = *(other.m_recordSchedule);
+  return (a.recordId == b.recordId &&
+          a.title == b.title &&
+          a.subtitle == b.subtitle &&
+          a.description == b.description &&
+          a.category == b.category &&
+          a.startTime == b.startTime &&
+          a.endTime == b.endTime &&
+          a.seriesId == b.seriesId &&
+          a.programId == b.programId &&
+          a.chanId == b.chanId &&
+          a.callSign == b.callSign &&
+          a.findDay == b.findDay &&
+          a.findTime == b.findTime &&
+          a.parentId == b.parentId &&
+          a.inactive == b.inactive &&
+          a.season == b.season &&
+          a.episode == b.episode &&
+          a.inetref == b.inetref &&
+          a.type_t == b.type_t &&
+          a.searchType_t == b.searchType_t &&
+          a.recPriority == b.recPriority &&
+          a.preferredInput == b.preferredInput &&
+          a.startOffset == b.startOffset &&
+          a.endOffset == b.endOffset &&
+          a.dupMethod_t == b.dupMethod_t &&
+          a.dupIn_t == b.dupIn_t &&
+          a.filter == b.filter &&
+          a.recProfile == b.recProfile &&
+          a.recGroup == b.recGroup &&
+          a.storageGroup == b.storageGroup &&
+          a.playGroup == b.playGroup &&
+          a.autoExpire == b.autoExpire &&
+          a.maxEpisodes == b.maxEpisodes &&
+          a.maxNewest == b.maxNewest &&
+          a.autoCommflag == b.autoCommflag &&
+          a.autoTranscode == b.autoTranscode &&
+          a.autoMetaLookup == b.autoMetaLookup &&
+          a.autoUserJob1 == b.autoUserJob1 &&
+          a.autoUserJob2 == b.autoUserJob2 &&
+          a.autoUserJob3 == b.autoUserJob3 &&
+          a.autoUserJob4 == b.autoUserJob4 &&
+          a.transcoder == b.transcoder &&
+          a.nextRecording == b.nextRecording &&
+          a.lastRecorded == b.lastRecorded &&
+          a.lastDeleted == b.lastDeleted &&
+          a.averageDelay == b.averageDelay);
+}
+
 uint32_t MythRecordingRule::RecordID() const
 {
   return m_recordSchedule->recordId;
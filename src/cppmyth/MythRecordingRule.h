@@ -31,6 +31,8 @@ public:
 
   Myth::RecordSchedulePtr GetPtr();
   MythRecordingRule DuplicateRecordingRule() const;
+  /// True when other holds the same settings and state of this rule
+  bool IsSameRevision(const MythRecordingRule& other) const;
 
   uint32_t RecordID() const;
   void SetRecordID(uint32_t recordid);
@@ -27,6 +27,8 @@
 #include "../tools.h"
 #include "private/cppdef.h"
 
+#include <p8-platform/threads/threads.h>
+
 #include <cstdio>
 #include <cassert>
 #include <math.h>
@@ -45,6 +47,81 @@ enum
   METHOD_DISCREET_UPDATE,
 };
 
+namespace
+{
+  /**
+   * Request the upcoming list in its own thread, so the caller can request
+   * the rule list meanwhile.
+   */
+  class UpcomingFetcher : public P8PLATFORM::CThread
+  {
+  public:
+    UpcomingFetcher(Myth::Control& control)
+    : CThread()
+    , m_control(control)
+    , m_done()
+    , m_list() { }
+
+    virtual ~UpcomingFetcher()
+    {
+      StopThread(0);
+    }
+
+    /// Wait for the fetched list. The thread must have been created.
+    Myth::ProgramListPtr GetResult()
+    {
+      m_done.Wait();
+      StopThread(0);
+      return m_list;
+    }
+
+  protected:
+    void *Process()
+    {
+      m_list = m_control.GetUpcomingList();
+      m_done.Signal();
+      return NULL;
+    }
+
+  private:
+    Myth::Control& m_control;
+    P8PLATFORM::CEvent m_done;
+    Myth::ProgramListPtr m_list;
+  };
+}
+
+static bool SameRecordingRuleNode(const MythRecordingRuleNode& first, const MythRecordingRuleNode& second)
+{
+  if (first.HasConflict() != second.HasConflict() || first.IsRecording() != second.IsRecording())
+    return false;
+  if (!first.GetRule().IsSameRevision(second.GetRule()) || !first.GetMainRule().IsSameRevision(second.GetMainRule()))
+    return false;
+  MythRecordingRuleList a = first.GetOverrideRules();
+  MythRecordingRuleList b = second.GetOverrideRules();
+  if (a.size() != b.size())
+    return false;
+  for (MythRecordingRuleList::size_type i = 0; i < a.size(); ++i)
+    if (!a[i].IsSameRevision(b[i]))
+      return false;
+  return true;
+}
+
+static bool SameUpcoming(const MythProgramInfo& first, const MythProgramInfo& second)
+{
+  return (first.IsSameRevision(second) &&
+          first.RecordID() == second.RecordID() &&
+          first.ChannelID() == second.ChannelID() &&
+          first.Callsign() == second.Callsign() &&
+          first.StartTime() == second.StartTime() &&
+          first.RecordingStartTime() == second.RecordingStartTime() &&
+          first.Priority() == second.Priority() &&
+          first.Title() == second.Title() &&
+          first.Subtitle() == second.Subtitle() &&
+          first.Description() == second.Description() &&
+          first.Season() == second.Season() &&
+          first.Episode() == second.Episode());
+}
+
 static uint_fast32_t hashvalue(uint_fast32_t maxsize, const char *value)
 {
   uint_fast32_t h = 0, g;
@@ -125,9 +202,11 @@ bool MythRecordingRuleNode::IsRecording() const
 
 MythScheduleManager::MythScheduleManager(const std::string& server, unsigned protoPort, unsigned wsapiPort, const std::string& wsapiSecurityPin)
 : m_lock()
+, m_updateLock()
 , m_control(NULL)
 , m_protoVersion(0)
 , m_versionHelper(NULL)
+, m_version(0)
 , m_rules(NULL)
 , m_rulesById(NULL)
 , m_rulesByIndex(NULL)
@@ -152,14 +231,14 @@ MythScheduleManager::~MythScheduleManager()
   SAFE_DELETE(m_control);
 }
 
-void MythScheduleManager::Setup()
+bool MythScheduleManager::Setup()
 {
   CLockObject lock(m_lock);
   int old = m_protoVersion;
   m_protoVersion = m_control->CheckService();
 
   // On new connection the protocol version could change
-  if (m_protoVersion != old)
+  if (m_protoVersion != old || !m_versionHelper)
   {
     SAFE_DELETE(m_versionHelper);
     if (m_protoVersion >= 85)
@@ -182,7 +261,9 @@ void MythScheduleManager::Setup()
       m_versionHelper = new MythScheduleHelperNoHelper();
       XBMC->Log(LOG_DEBUG, "Using MythScheduleHelperNoHelper");
     }
+    return true;
   }
+  return false;
 }
 
 uint32_t MythScheduleManager::MakeIndex(const MythProgramInfo& recording)
@@ -207,6 +288,12 @@ unsigned MythScheduleManager::GetUpcomingCount() const
   return (unsigned)m_recordings->size();
 }
 
+unsigned MythScheduleManager::GetVersion() const
+{
+  CLockObject lock(m_lock);
+  return m_version;
+}
+
 MythTimerEntryList MythScheduleManager::GetTimerEntries()
 {
   CLockObject lock(m_lock);
@@ -230,7 +317,7 @@ MythTimerEntryList MythScheduleManager::GetTimerEntries()
   return entries;
 }
 
-MythScheduleManager::MSM_ERROR MythScheduleManager::SubmitTimer(const MythTimerEntry& entry)
+MythScheduleManager::MSM_ERROR MythScheduleManager::SubmitTimer(const MythTimerEntry& entry, const Myth::ProgramList& preview)
 {
   CLockObject lock(m_lock);
   switch (entry.timerType)
@@ -250,6 +337,8 @@ MythScheduleManager::MSM_ERROR MythScheduleManager::SubmitTimer(const MythTimerE
   }
   MythRecordingRule rule = m_versionHelper->RuleFromMythTimer(entry);
   MSM_ERROR ret = AddRecordingRule(rule);
+  if (ret == MSM_ERROR_SUCCESS)
+    SyncPreviewUpcomings(rule, preview);
   return ret;
 }
 
@@ -405,7 +494,8 @@ MythScheduleManager::MSM_ERROR MythScheduleManager::DisableRecording(uint32_t in
         handle.SetInactive(true);
         if (!m_control->UpdateRecordSchedule(*(handle.GetPtr())))
           return MSM_ERROR_FAILED;
-        node->m_rule = handle; // sync node
+        SyncRule(*node, handle);
+        SyncRuleUpcomingStatus(handle.RecordID(), Myth::RS_UNKNOWN, Myth::RS_INACTIVE);
         return MSM_ERROR_SUCCESS;
 
       case METHOD_CREATE_DONTRECORD:
@@ -424,7 +514,8 @@ MythScheduleManager::MSM_ERROR MythScheduleManager::DisableRecording(uint32_t in
         {
           if (!m_control->AddRecordSchedule(*(handle.GetPtr())))
             return MSM_ERROR_FAILED;
-          node->m_overrideRules.push_back(handle); // sync node
+          SyncOverrideRule(*node, handle);
+          SyncUpcomingStatus(index, Myth::RS_DONT_RECORD);
         }
         return MSM_ERROR_SUCCESS;
 
@@ -479,7 +570,8 @@ MythScheduleManager::MSM_ERROR MythScheduleManager::EnableRecording(uint32_t ind
         handle.SetInactive(false);
         if (!m_control->UpdateRecordSchedule(*(handle.GetPtr())))
           return MSM_ERROR_FAILED;
-        node->m_rule = handle; // sync node
+        SyncRule(*node, handle);
+        SyncRuleUpcomingStatus(handle.RecordID(), Myth::RS_INACTIVE, Myth::RS_WILL_RECORD);
         return MSM_ERROR_SUCCESS;
 
       case METHOD_CREATE_OVERRIDE:
@@ -490,7 +582,8 @@ MythScheduleManager::MSM_ERROR MythScheduleManager::EnableRecording(uint32_t ind
 
         if (!m_control->AddRecordSchedule(*(handle.GetPtr())))
           return MSM_ERROR_FAILED;
-        node->m_overrideRules.push_back(handle); // sync node
+        SyncOverrideRule(*node, handle);
+        SyncUpcomingStatus(index, Myth::RS_WILL_RECORD);
         return MSM_ERROR_SUCCESS;
 
       default:
@@ -599,7 +692,7 @@ MythScheduleManager::MSM_ERROR MythScheduleManager::UpdateRecording(uint32_t ind
       case METHOD_DISCREET_UPDATE:
         if (!m_control->UpdateRecordSchedule(*(handle.GetPtr())))
           return MSM_ERROR_FAILED;
-        node->m_rule = handle; // sync node
+        SyncRule(*node, handle);
         return MSM_ERROR_SUCCESS;
 
       case METHOD_CREATE_OVERRIDE:
@@ -610,7 +703,8 @@ MythScheduleManager::MSM_ERROR MythScheduleManager::UpdateRecording(uint32_t ind
 
         if (!m_control->AddRecordSchedule(*(handle.GetPtr())))
           return MSM_ERROR_FAILED;
-        node->m_overrideRules.push_back(handle); // sync node
+        SyncOverrideRule(*node, handle);
+        SyncUpcomingStatus(index, Myth::RS_WILL_RECORD);
         return MSM_ERROR_SUCCESS;
 
       default:
@@ -622,10 +716,13 @@ MythScheduleManager::MSM_ERROR MythScheduleManager::UpdateRecording(uint32_t ind
 
 MythScheduleManager::MSM_ERROR MythScheduleManager::AddRecordingRule(MythRecordingRule &rule)
 {
+  CLockObject lock(m_lock);
+
   if (rule.Type() == Myth::RT_UNKNOWN || rule.Type() == Myth::RT_NotRecording)
     return MSM_ERROR_FAILED;
   if (!m_control->AddRecordSchedule(*(rule.GetPtr())))
     return MSM_ERROR_FAILED;
+  SyncNewRule(rule);
   return MSM_ERROR_SUCCESS;
 }
 
@@ -638,6 +735,8 @@ MythScheduleManager::MSM_ERROR MythScheduleManager::DeleteRecordingRule(uint32_t
   {
     XBMC->Log(LOG_DEBUG, "%s: Found rule %u type %d", __FUNCTION__, (unsigned)node->m_rule.RecordID(), (int)node->m_rule.Type());
 
+    // Only rules deleted on the backend are removed locally
+    std::vector<uint32_t> deleted;
     // Delete overrides and their related recording
     if (node->HasOverrideRules())
     {
@@ -655,7 +754,9 @@ MythScheduleManager::MSM_ERROR MythScheduleManager::DeleteRecordingRule(uint32_t
           }
         }
         XBMC->Log(LOG_DEBUG, "%s: Deleting recording rule %u (modifier of rule %u)", __FUNCTION__, (unsigned)ito->RecordID(), (unsigned)node->m_rule.RecordID());
-        if (!m_control->RemoveRecordSchedule(ito->RecordID()))
+        if (m_control->RemoveRecordSchedule(ito->RecordID()))
+          deleted.push_back(ito->RecordID());
+        else
           XBMC->Log(LOG_ERROR, "%s: Deleting recording rule failed", __FUNCTION__);
       }
     }
@@ -672,8 +773,12 @@ MythScheduleManager::MSM_ERROR MythScheduleManager::DeleteRecordingRule(uint32_t
     }
     // Delete rule
     XBMC->Log(LOG_DEBUG, "%s: Deleting recording rule %u", __FUNCTION__, node->m_rule.RecordID());
-    if (!m_control->RemoveRecordSchedule(node->m_rule.RecordID()))
+    if (m_control->RemoveRecordSchedule(node->m_rule.RecordID()))
+      deleted.push_back(node->m_rule.RecordID());
+    else
       XBMC->Log(LOG_ERROR, "%s: Deleting recording rule failed", __FUNCTION__);
+    for (std::vector<uint32_t>::const_iterator itd = deleted.begin(); itd != deleted.end(); ++itd)
+      SyncDeletedRule(*itd);
   }
   // Another client could delete the rule at the same time. Therefore always SUCCESS even if database delete fails.
   return MSM_ERROR_SUCCESS;
@@ -762,7 +867,7 @@ MythScheduleManager::MSM_ERROR MythScheduleManager::UpdateRecordingRule(uint32_t
       case METHOD_DISCREET_UPDATE:
         if (!m_control->UpdateRecordSchedule(*(handle.GetPtr())))
           return MSM_ERROR_FAILED;
-        node->m_rule = handle; // sync node
+        SyncRule(*node, handle);
         return MSM_ERROR_SUCCESS;
 
       default:
@@ -772,6 +877,144 @@ MythScheduleManager::MSM_ERROR MythScheduleManager::UpdateRecordingRule(uint32_t
   return MSM_ERROR_FAILED;
 }
 
+void MythScheduleManager::SyncRule(MythRecordingRuleNode& node, const MythRecordingRule& rule)
+{
+  CLockObject lock(m_lock);
+  node.m_rule = rule;
+  ++m_version;
+}
+
+void MythScheduleManager::SyncOverrideRule(MythRecordingRuleNode& node, const MythRecordingRule& rule)
+{
+  CLockObject lock(m_lock);
+  node.m_overrideRules.push_back(rule);
+  ++m_version;
+}
+
+void MythScheduleManager::SyncNewRule(const MythRecordingRule& rule)
+{
+  // The backend returns the id of the new rule
+  if (rule.RecordID() == 0)
+    return;
+  CLockObject lock(m_lock);
+  if (m_rulesById->find(rule.RecordID()) != m_rulesById->end())
+    return;
+  MythRecordingRuleNodePtr node = MythRecordingRuleNodePtr(new MythRecordingRuleNode(rule));
+  m_rules->push_back(node);
+  m_rulesById->insert(NodeById::value_type(rule.RecordID(), node));
+  m_rulesByIndex->insert(NodeByIndex::value_type(MakeIndex(rule), node));
+  ++m_version;
+}
+
+void MythScheduleManager::SyncDeletedRule(uint32_t recordid)
+{
+  CLockObject lock(m_lock);
+  NodeById::iterator it = m_rulesById->find(recordid);
+  if (it == m_rulesById->end())
+    return;
+  MythRecordingRuleNodePtr node = it->second;
+  m_rulesById->erase(it);
+  m_rulesByIndex->erase(MakeIndex(node->m_rule));
+  for (NodeList::iterator itn = m_rules->begin(); itn != m_rules->end(); ++itn)
+  {
+    if (itn->get() == node.get())
+    {
+      m_rules->erase(itn);
+      break;
+    }
+  }
+  MythRecordingRuleNodePtr mainNode;
+  if (node->IsOverrideRule())
+  {
+    // Unlink the override from its main rule
+    NodeById::iterator itm = m_rulesById->find(node->m_mainRule.RecordID());
+    if (itm != m_rulesById->end())
+    {
+      mainNode = itm->second;
+      for (MythRecordingRuleList::iterator ito = mainNode->m_overrideRules.begin(); ito != mainNode->m_overrideRules.end(); ++ito)
+      {
+        if (ito->RecordID() == recordid)
+        {
+          mainNode->m_overrideRules.erase(ito);
+          break;
+        }
+      }
+    }
+  }
+  std::pair<RecordingIndexByRuleId::iterator, RecordingIndexByRuleId::iterator> range = m_recordingIndexByRuleId->equal_range(recordid);
+  for (RecordingIndexByRuleId::iterator itr = range.first; itr != range.second; ++itr)
+  {
+    RecordingList::iterator itu = m_recordings->find(itr->second);
+    if (itu == m_recordings->end())
+      continue;
+    if (!mainNode)
+    {
+      // Remove its upcoming recordings
+      m_recordings->erase(itu);
+      continue;
+    }
+    // The airing falls back to the main rule: replace the entry by a modified copy
+    Myth::ProgramPtr program(new Myth::Program(*(itu->second->GetPtr())));
+    program->recording.recordId = mainNode->m_rule.RecordID();
+    program->recording.recType = static_cast<uint8_t>(mainNode->m_rule.Type());
+    program->recording.status = static_cast<int8_t>(mainNode->m_rule.Inactive() ? Myth::RS_INACTIVE : Myth::RS_WILL_RECORD);
+    itu->second = MythScheduledPtr(new MythProgramInfo(program));
+    m_recordingIndexByRuleId->insert(RecordingIndexByRuleId::value_type(mainNode->m_rule.RecordID(), itr->second));
+  }
+  m_recordingIndexByRuleId->erase(range.first, range.second);
+  ++m_version;
+}
+
+void MythScheduleManager::SyncUpcomingStatus(uint32_t index, Myth::RS_t status)
+{
+  CLockObject lock(m_lock);
+  RecordingList::iterator it = m_recordings->find(index);
+  if (it == m_recordings->end() || it->second->Status() == status)
+    return;
+  // Upcoming recordings are shared with the callers: replace the entry by a modified copy
+  Myth::ProgramPtr program(new Myth::Program(*(it->second->GetPtr())));
+  program->recording.status = static_cast<int8_t>(status);
+  it->second = MythScheduledPtr(new MythProgramInfo(program));
+  ++m_version;
+}
+
+void MythScheduleManager::SyncRuleUpcomingStatus(uint32_t recordid, Myth::RS_t from, Myth::RS_t to)
+{
+  CLockObject lock(m_lock);
+  std::pair<RecordingIndexByRuleId::const_iterator, RecordingIndexByRuleId::const_iterator> range = m_recordingIndexByRuleId->equal_range(recordid);
+  for (RecordingIndexByRuleId::const_iterator it = range.first; it != range.second; ++it)
+  {
+    RecordingList::const_iterator itr = m_recordings->find(it->second);
+    // RS_UNKNOWN matches any status
+    if (itr != m_recordings->end() && (from == Myth::RS_UNKNOWN || itr->second->Status() == from))
+      SyncUpcomingStatus(it->second, to);
+  }
+}
+
+void MythScheduleManager::SyncPreviewUpcomings(const MythRecordingRule& rule, const Myth::ProgramList& preview)
+{
+  if (rule.RecordID() == 0 || preview.empty())
+    return;
+  CLockObject lock(m_lock);
+  for (Myth::ProgramList::const_iterator it = preview.begin(); it != preview.end(); ++it)
+  {
+    // The backend will tell about duplicates and conflicts: expect the airing to be recorded
+    Myth::ProgramPtr program(new Myth::Program(**it));
+    program->recording.recordId = rule.RecordID();
+    program->recording.recType = static_cast<uint8_t>(rule.Type());
+    program->recording.status = static_cast<int8_t>(Myth::RS_WILL_RECORD);
+    program->recording.startTs = program->startTime;
+    program->recording.endTs = program->endTime;
+    MythScheduledPtr scheduled = MythScheduledPtr(new MythProgramInfo(program));
+    uint32_t index = MakeIndex(*scheduled);
+    if (m_recordings->find(index) != m_recordings->end())
+      continue;
+    m_recordings->insert(RecordingList::value_type(index, scheduled));
+    m_recordingIndexByRuleId->insert(RecordingIndexByRuleId::value_type(rule.RecordID(), index));
+  }
+  ++m_version;
+}
+
 MythRecordingRuleNodePtr MythScheduleManager::FindRuleById(uint32_t recordid) const
 {
   CLockObject lock(m_lock);
@@ -833,10 +1076,30 @@ void MythScheduleManager::CloseControl()
     m_control->Close();
 }
 
-void MythScheduleManager::Update()
+MythTimerIndexSet MythScheduleManager::Update()
+{
+  CLockObject updateLock(m_updateLock);
+  MythTimerIndexSet changes;
+  // Setup VersionHelper for the new set. A new helper could fill the entries differently.
+  bool reset = this->Setup();
+  // Publishing would discard the local syncs made during the fetch: fetch again then
+  while (!FetchAndPublish(reset, changes))
+  {
+    XBMC->Log(LOG_DEBUG, "%s: Schedule synced during the fetch, fetching again", __FUNCTION__);
+    changes.clear();
+  }
+  return changes;
+}
+
+bool MythScheduleManager::FetchAndPublish(bool reset, MythTimerIndexSet& changes)
 {
-  // Setup VersionHelper for the new set
-  this->Setup();
+  unsigned startVersion = GetVersion();
+  // Request the rule list and the upcoming list concurrently
+  UpcomingFetcher fetcher(*m_control);
+  bool fetching = fetcher.CreateThread(false);
+  Myth::RecordScheduleListPtr records = m_control->GetRecordScheduleList();
+  Myth::ProgramListPtr recordings = (fetching ? fetcher.GetResult() : m_control->GetUpcomingList());
+
   // Allocate containers
   NodeList* new_rules = new NodeList;
   NodeById* new_rulesById = new NodeById;
@@ -844,8 +1107,8 @@ void MythScheduleManager::Update()
   MythRecordingRuleList* new_templates = new MythRecordingRuleList;
   RecordingList* new_recordings = new RecordingList;
   RecordingIndexByRuleId* new_recordingIndexByRuleId = new RecordingIndexByRuleId;
+  NodeByTimeslot rulesByTimeslot;
 
-  Myth::RecordScheduleListPtr records = m_control->GetRecordScheduleList();
   for (Myth::RecordScheduleList::iterator it = records->begin(); it != records->end(); ++it)
   {
     MythRecordingRule rule(*it);
@@ -859,6 +1122,8 @@ void MythScheduleManager::Update()
       new_rules->push_back(node);
       new_rulesById->insert(NodeById::value_type(rule.RecordID(), node));
       new_rulesByIndex->insert(NodeByIndex::value_type(MakeIndex(rule), node));
+      if (!node->IsOverrideRule())
+        rulesByTimeslot.insert(NodeByTimeslot::value_type(std::make_pair(rule.ChannelID(), rule.StartTime()), node));
     }
   }
 
@@ -876,19 +1141,20 @@ void MythScheduleManager::Update()
       }
       else
       {
-        for (NodeList::iterator itm = new_rules->begin(); itm != new_rules->end(); ++itm)
-          if (!(*itm)->IsOverrideRule() && m_versionHelper->SameTimeslot((*it)->m_rule, (*itm)->m_rule))
+        // An override matches the channel and the start time of its main rule
+        std::pair<NodeByTimeslot::iterator, NodeByTimeslot::iterator> range =
+                rulesByTimeslot.equal_range(std::make_pair((*it)->m_rule.ChannelID(), (*it)->m_rule.StartTime()));
+        for (NodeByTimeslot::iterator itm = range.first; itm != range.second; ++itm)
+          if (m_versionHelper->SameTimeslot((*it)->m_rule, itm->second->m_rule))
           {
-            (*itm)->m_overrideRules.push_back((*it)->m_rule);
-            (*it)->m_mainRule = (*itm)->m_rule;
+            itm->second->m_overrideRules.push_back((*it)->m_rule);
+            (*it)->m_mainRule = itm->second->m_rule;
           }
-
       }
     }
   }
 
   // Add upcoming recordings
-  Myth::ProgramListPtr recordings = m_control->GetUpcomingList();
   for (Myth::ProgramList::iterator it = recordings->begin(); it != recordings->end(); ++it)
   {
     MythScheduledPtr scheduled = MythScheduledPtr(new MythProgramInfo(*it));
@@ -918,7 +1184,60 @@ void MythScheduleManager::Update()
     }
   }
 
-  if (g_bExtraDebug)
+  // Diff against the current set: unchanged rule nodes and upcoming recordings
+  // are reused, so their pointers stay valid for the holders
+  bool synced = false;
+  {
+    CLockObject lock(m_lock);
+    if (m_version != startVersion)
+      synced = true;
+    else if (m_rules && m_recordings && !reset)
+    {
+      for (NodeList::iterator it = new_rules->begin(); it != new_rules->end(); ++it)
+      {
+        uint32_t index = MakeIndex((*it)->m_rule);
+        NodeById::const_iterator old = m_rulesById->find((*it)->m_rule.RecordID());
+        if (old != m_rulesById->end() && SameRecordingRuleNode(*(old->second), **it))
+        {
+          *it = old->second;
+          (*new_rulesById)[(*it)->m_rule.RecordID()] = old->second;
+          (*new_rulesByIndex)[index] = old->second;
+        }
+        else
+          changes.insert(index);
+      }
+      for (NodeByIndex::const_iterator it = m_rulesByIndex->begin(); it != m_rulesByIndex->end(); ++it)
+        if (new_rulesByIndex->find(it->first) == new_rulesByIndex->end())
+          changes.insert(it->first);
+
+      for (RecordingList::iterator it = new_recordings->begin(); it != new_recordings->end(); ++it)
+      {
+        RecordingList::const_iterator old = m_recordings->find(it->first);
+        if (old != m_recordings->end() && SameUpcoming(*(old->second), *(it->second)))
+          it->second = old->second;
+        else
+          changes.insert(it->first);
+      }
+      for (RecordingList::const_iterator it = m_recordings->begin(); it != m_recordings->end(); ++it)
+        if (new_recordings->find(it->first) == new_recordings->end())
+          changes.insert(it->first);
+    }
+    else
+    {
+      for (NodeByIndex::const_iterator it = new_rulesByIndex->begin(); it != new_rulesByIndex->end(); ++it)
+        changes.insert(it->first);
+      for (RecordingList::const_iterator it = new_recordings->begin(); it != new_recordings->end(); ++it)
+        changes.insert(it->first);
+      if (m_rulesByIndex)
+        for (NodeByIndex::const_iterator it = m_rulesByIndex->begin(); it != m_rulesByIndex->end(); ++it)
+          changes.insert(it->first);
+      if (m_recordings)
+        for (RecordingList::const_iterator it = m_recordings->begin(); it != m_recordings->end(); ++it)
+          changes.insert(it->first);
+    }
+  }
+
+  if (g_bExtraDebug && !synced)
   {
     for (NodeList::iterator it = new_rules->begin(); it != new_rules->end(); ++it)
       XBMC->Log(LOG_DEBUG, "%s: Rule node - recordid: %u, parentid: %u, type: %d, overriden: %s", __FUNCTION__,
@@ -928,9 +1247,20 @@ void MythScheduleManager::Update()
       XBMC->Log(LOG_DEBUG, "%s: Recording - recordid: %u, index: %u, status: %d, title: %s", __FUNCTION__,
               (unsigned)it->second->RecordID(), (unsigned)it->first, it->second->Status(), it->second->Title().c_str());
   }
-  
   {
     CLockObject lock(m_lock);
+    if (synced || m_version != startVersion)
+    {
+      delete new_recordingIndexByRuleId;
+      delete new_recordings;
+      delete new_templates;
+      delete new_rulesByIndex;
+      delete new_rulesById;
+      delete new_rules;
+      return false;
+    }
+    XBMC->Log(LOG_DEBUG, "%s: rules: %u, upcomings: %u, changed: %u", __FUNCTION__,
+            (unsigned)new_rules->size(), (unsigned)new_recordings->size(), (unsigned)changes.size());
     SAFE_DELETE(m_recordingIndexByRuleId);
     SAFE_DELETE(m_recordings);
     SAFE_DELETE(m_templates);
@@ -943,7 +1273,10 @@ void MythScheduleManager::Update()
     m_templates = new_templates;
     m_recordings = new_recordings;
     m_recordingIndexByRuleId = new_recordingIndexByRuleId;
+    if (!changes.empty())
+      ++m_version;
   }
+  return true;
 }
 
 MythTimerTypeList MythScheduleManager::GetTimerTypes()
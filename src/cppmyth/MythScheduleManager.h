@@ -31,6 +31,7 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <set>
 
 typedef enum
 {
@@ -112,6 +113,7 @@ typedef std::vector<std::pair<uint32_t, MythScheduledPtr> > MythScheduleList;
 
 typedef MYTH_SHARED_PTR<MythTimerEntry> MythTimerEntryPtr;
 typedef std::vector<MythTimerEntryPtr> MythTimerEntryList;
+typedef std::set<uint32_t> MythTimerIndexSet;
 
 class MythTimerType;
 typedef MYTH_SHARED_PTR<MythTimerType> MythTimerTypePtr;
@@ -157,9 +159,12 @@ public:
 
   // Called by GetTimers
   unsigned GetUpcomingCount() const;
+  /// Version of the schedule, bumped each time the timer entries could change
+  unsigned GetVersion() const;
   MythTimerEntryList GetTimerEntries();
 
-  MSM_ERROR SubmitTimer(const MythTimerEntry& entry);
+  /// Add the rule of entry. The given airings are shown as upcoming recordings of the new rule until the next update.
+  MSM_ERROR SubmitTimer(const MythTimerEntry& entry, const Myth::ProgramList& preview = Myth::ProgramList());
   MSM_ERROR UpdateTimer(const MythTimerEntry& entry);
   MSM_ERROR DeleteTimer(const MythTimerEntry& entry);
 
@@ -181,7 +186,8 @@ public:
 
   bool OpenControl();
   void CloseControl();
-  void Update();
+  /// Reload the schedule and return the indexes of the rules and upcoming recordings added, changed or removed
+  MythTimerIndexSet Update();
 
   MythTimerTypeList GetTimerTypes();
   bool FillTimerEntryWithRule(MythTimerEntry& entry, const MythRecordingRuleNode& node) const;
@@ -218,11 +224,15 @@ public:
 
 private:
   mutable P8PLATFORM::CMutex m_lock;
+  P8PLATFORM::CMutex m_updateLock;          //!< @brief Serialize updates as they diff against the current set
   Myth::Control *m_control;
 
   int m_protoVersion;
   VersionHelper *m_versionHelper;
-  void Setup();
+  unsigned m_version;
+  bool Setup();
+  /// Fetch the schedule and publish it unless it was synced meanwhile. Changes are diffed against the current set.
+  bool FetchAndPublish(bool reset, MythTimerIndexSet& changes);
 
   // The list of rule nodes
   typedef std::list<MythRecordingRuleNodePtr> NodeList;
@@ -234,6 +244,17 @@ private:
   typedef std::map<uint32_t, MythScheduledPtr> RecordingList;
   // To find all indexes of schedule by rule Id : pair < Rule Id , index of schedule >
   typedef std::multimap<uint32_t, uint32_t> RecordingIndexByRuleId;
+  // To find the candidate main rules of an override by timeslot : pair < chanid , start time >
+  typedef std::multimap<std::pair<uint32_t, time_t>, MythRecordingRuleNodePtr> NodeByTimeslot;
+
+  // Apply a successful change locally until the next update reconciles the set
+  void SyncRule(MythRecordingRuleNode& node, const MythRecordingRule& rule);
+  void SyncOverrideRule(MythRecordingRuleNode& node, const MythRecordingRule& rule);
+  void SyncNewRule(const MythRecordingRule& rule);
+  void SyncDeletedRule(uint32_t recordid);
+  void SyncUpcomingStatus(uint32_t index, Myth::RS_t status);
+  void SyncRuleUpcomingStatus(uint32_t recordid, Myth::RS_t from, Myth::RS_t to);
+  void SyncPreviewUpcomings(const MythRecordingRule& rule, const Myth::ProgramList& preview);
 
   NodeList* m_rules;
   NodeById* m_rulesById;
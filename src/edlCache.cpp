@@ -0,0 +1,190 @@
+/*
+ *      Copyright (C) 2005-2014 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301 USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "edlCache.h"
+#include "client.h"
+
+using namespace ADDON;
+using namespace P8PLATFORM;
+
+EdlCache::EdlCache(Myth::Control& control)
+: CThread()
+, m_control(control)
+, m_queueContent()
+, m_jobDone()
+, m_entries()
+, m_lru()
+, m_jobs()
+{
+  CreateThread();
+}
+
+EdlCache::~EdlCache()
+{
+  StopThread(-1); // Set stopping. don't wait as we need to signal the thread first
+  m_queueContent.Signal();
+  StopThread(); // Wait for thread to stop
+}
+
+bool EdlCache::Find(const MythProgramInfo& programInfo, int unit, Myth::MarkListPtr& commBreaks, Myth::MarkListPtr& cuts)
+{
+  CLockObject lock(m_lock);
+  EntryMap::iterator it = m_entries.find(programInfo.Key());
+  if (it == m_entries.end())
+    return false;
+  if (it->second.unit != unit || !it->second.revision.IsSameRevision(programInfo))
+  {
+    m_lru.erase(it->second.lru);
+    m_entries.erase(it);
+    return false;
+  }
+  m_lru.splice(m_lru.end(), m_lru, it->second.lru);
+  commBreaks = it->second.commBreaks;
+  cuts = it->second.cuts;
+  return true;
+}
+
+void EdlCache::Store(const MythProgramInfo& programInfo, int unit, Myth::MarkListPtr commBreaks, Myth::MarkListPtr cuts)
+{
+  MythProgramKey key = programInfo.Key();
+  CLockObject lock(m_lock);
+  EntryMap::iterator it = m_entries.find(key);
+  if (it == m_entries.end())
+  {
+    it = m_entries.insert(std::make_pair(key, Entry())).first;
+    it->second.lru = m_lru.insert(m_lru.end(), key);
+  }
+  else
+    m_lru.splice(m_lru.end(), m_lru, it->second.lru);
+  it->second.revision = programInfo;
+  it->second.unit = unit;
+  it->second.commBreaks = commBreaks;
+  it->second.cuts = cuts;
+  while (m_entries.size() > c_maximumEntries)
+  {
+    m_entries.erase(m_lru.front());
+    m_lru.pop_front();
+  }
+}
+
+void EdlCache::GetMarks(const MythProgramInfo& programInfo, int unit, Myth::MarkListPtr& commBreaks, Myth::MarkListPtr& cuts)
+{
+  if (Find(programInfo, unit, commBreaks, cuts))
+  {
+    if (g_bExtraDebug)
+      XBMC->Log(LOG_DEBUG, "%s: Found marks in cache for %s", __FUNCTION__, programInfo.UID().c_str());
+    return;
+  }
+
+  // Let the worker request the commercial breaks while we request the cut list
+  JobPtr job(new Job());
+  job->programInfo = programInfo;
+  job->unit = unit;
+  job->prefetch = false;
+  job->done = false;
+  CLockObject lock(m_lock);
+  m_jobs.push_front(job);
+  m_queueContent.Signal();
+  lock.Unlock();
+
+  cuts = m_control.GetCutList(*(programInfo.GetPtr()), unit);
+
+  lock.Lock();
+  while (!job->done && IsRunning())
+  {
+    lock.Unlock();
+    m_jobDone.Wait(1000);
+    lock.Lock();
+  }
+  commBreaks = job->commBreaks;
+  lock.Unlock();
+  if (!commBreaks)
+    commBreaks = m_control.GetCommBreakList(*(programInfo.GetPtr()), unit);
+  Store(programInfo, unit, commBreaks, cuts);
+}
+
+void EdlCache::Prefetch(const MythProgramInfo& programInfo, int unit)
+{
+  JobPtr job(new Job());
+  job->programInfo = programInfo;
+  job->unit = unit;
+  job->prefetch = true;
+  job->done = false;
+  CLockObject lock(m_lock);
+  m_jobs.push_back(job);
+  m_queueContent.Signal();
+}
+
+void EdlCache::Invalidate(const MythProgramInfo& programInfo)
+{
+  CLockObject lock(m_lock);
+  EntryMap::iterator it = m_entries.find(programInfo.Key());
+  if (it != m_entries.end())
+  {
+    m_lru.erase(it->second.lru);
+    m_entries.erase(it);
+  }
+}
+
+void *EdlCache::Process()
+{
+  XBMC->Log(LOG_DEBUG, "%s: EdlCache Thread Started", __FUNCTION__);
+
+  while (!IsStopped())
+  {
+    CLockObject lock(m_lock);
+    if (m_jobs.empty())
+    {
+      lock.Unlock();
+      m_queueContent.Wait();
+      continue;
+    }
+    JobPtr job = m_jobs.front();
+    m_jobs.pop_front();
+    lock.Unlock();
+
+    if (job->prefetch)
+    {
+      Myth::MarkListPtr commBreaks, cuts;
+      if (!Find(job->programInfo, job->unit, commBreaks, cuts))
+      {
+        commBreaks = m_control.GetCommBreakList(*(job->programInfo.GetPtr()), job->unit);
+        cuts = m_control.GetCutList(*(job->programInfo.GetPtr()), job->unit);
+        Store(job->programInfo, job->unit, commBreaks, cuts);
+        if (g_bExtraDebug)
+          XBMC->Log(LOG_DEBUG, "%s: Prefetched marks for %s", __FUNCTION__, job->programInfo.UID().c_str());
+      }
+    }
+    else
+    {
+      Myth::MarkListPtr commBreaks = m_control.GetCommBreakList(*(job->programInfo.GetPtr()), job->unit);
+      lock.Lock();
+      job->commBreaks = commBreaks;
+      job->done = true;
+      lock.Unlock();
+      m_jobDone.Broadcast();
+    }
+  }
+
+  XBMC->Log(LOG_DEBUG, "%s: EdlCache Thread Stopped", __FUNCTION__);
+  return NULL;
+}
@@ -0,0 +1,87 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2014 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301 USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "cppmyth/MythProgramInfo.h"
+
+#include <mythcontrol.h>
+#include <mythsharedptr.h>
+#include <p8-platform/threads/threads.h>
+
+#include <list>
+
+/**
+ * Cache of the commercial breaks and cut list of the recordings. An entry is
+ * bound to the revision of the recording it was fetched for. On a miss both
+ * lists are fetched in parallel: the worker thread requests the commercial
+ * breaks while the caller requests the cut list. The worker also prefetches
+ * entries in background.
+ */
+class EdlCache : public P8PLATFORM::CThread
+{
+public:
+  static const unsigned c_maximumEntries = 64;  // Drop least recently used entries over this count
+
+  EdlCache(Myth::Control& control);
+  virtual ~EdlCache();
+
+  /// Get the commercial breaks and the cut list of programInfo, fetching them on a miss
+  void GetMarks(const MythProgramInfo& programInfo, int unit, Myth::MarkListPtr& commBreaks, Myth::MarkListPtr& cuts);
+  /// Fetch the marks of programInfo in background unless cached
+  void Prefetch(const MythProgramInfo& programInfo, int unit);
+  void Invalidate(const MythProgramInfo& programInfo);
+
+protected:
+  void *Process();
+
+private:
+  struct Entry
+  {
+    MythProgramInfo revision;
+    int unit;
+    Myth::MarkListPtr commBreaks;
+    Myth::MarkListPtr cuts;
+    std::list<MythProgramKey>::iterator lru;
+  };
+  typedef std::unordered_map<MythProgramKey, Entry, MythProgramKeyHash> EntryMap;
+
+  struct Job
+  {
+    MythProgramInfo programInfo;
+    int unit;
+    bool prefetch;                ///< Fetch both lists and store them, else only the commercial breaks
+    bool done;
+    Myth::MarkListPtr commBreaks;
+  };
+  typedef MYTH_SHARED_PTR<Job> JobPtr;
+
+  bool Find(const MythProgramInfo& programInfo, int unit, Myth::MarkListPtr& commBreaks, Myth::MarkListPtr& cuts);
+  void Store(const MythProgramInfo& programInfo, int unit, Myth::MarkListPtr commBreaks, Myth::MarkListPtr cuts);
+
+  Myth::Control& m_control;
+  P8PLATFORM::CMutex m_lock;
+  P8PLATFORM::CEvent m_queueContent;
+  P8PLATFORM::CEvent m_jobDone;
+  EntryMap m_entries;
+  std::list<MythProgramKey> m_lru;  ///< Keys from least to most recently used
+  std::list<JobPtr> m_jobs;
+};
@@ -28,29 +28,62 @@
 #include <algorithm>
 
 #define FILEOPS_STREAM_BUFFER_SIZE    32000         // Buffer size to download artworks
-#define FILEOPS_STAMP_FILENAME        "stamp"       // Base name for cache stamp file
-#define FILEOPS_NOSTAMP               (time_t)(-1)
+#define FILEOPS_INDEX_FILENAME        "index"       // Base name for cache index file
+#define FILEOPS_INDEX_MAGIC           "MYTHARTWORK"
+#define FILEOPS_INDEX_VERSION         1
 #define FILEOPS_CHANNEL_DUMMY_ICON    "channel.png"
 #define FILEOPS_RECORDING_DUMMY_ICON  "recording.png"
 
 using namespace ADDON;
 using namespace P8PLATFORM;
 
-FileOps::FileOps(FileConsumer *consumer, const std::string& server, unsigned wsapiport, const std::string& wsapiSecurityPin)
+class FileOps::Worker : public CThread
+{
+public:
+  Worker(FileOps& fileOps)
+  : CThread()
+  , m_fileOps(fileOps) { }
+
+protected:
+  void *Process()
+  {
+    while (!IsStopped())
+    {
+      if (!m_fileOps.ProcessNextJob())
+        m_fileOps.m_jobReady.Wait(c_timeoutProcess * 1000);
+    }
+    return NULL;
+  }
+
+private:
+  FileOps& m_fileOps;
+};
+
+FileOps::FileOps(const std::string& server, unsigned wsapiport, const std::string& wsapiSecurityPin)
 : CThread()
-, m_consumer(consumer)
 , m_wsapi(NULL)
 , m_localBasePath(g_szUserPath.c_str())
-, m_localBaseStampName()
-, m_localBaseStamp(FILEOPS_NOSTAMP)
+, m_indexFilename()
 , m_queueContent()
+, m_jobReady()
 , m_jobQueue()
+, m_jobQueueDelayed()
+, m_pendingFiles()
+, m_failedFiles()
+, m_workers()
+, m_index()
+, m_indexSize(0)
+, m_indexModified(false)
+, m_indexSaved(time(NULL))
+, m_evictedFiles()
+, m_filesToDelete()
 {
   // Initialize base path for cache directories
   m_localBasePath.append("cache").append(PATH_SEPARATOR_STRING);
-  m_localBaseStampName.append(m_localBasePath).append(FILEOPS_STAMP_FILENAME);
+  m_indexFilename.append(m_localBasePath).append(FILEOPS_INDEX_FILENAME);
   InitBasePath();
   m_wsapi = new Myth::WSAPI(server, wsapiport, wsapiSecurityPin);
+  StartWorkers();
   CreateThread();
 }
 
@@ -59,7 +92,11 @@ FileOps::~FileOps()
   StopThread(-1); // Set stopping. don't wait as we need to signal the thread first
   m_queueContent.Signal();
   StopThread(); // Wait for thread to stop
+  StopWorkers();
   SAFE_DELETE(m_wsapi);
+  CLockObject lock(m_lock);
+  if (m_indexModified)
+    SaveIndex();
 }
 
 std::string FileOps::GetChannelIconPath(const MythChannel& channel)
@@ -73,25 +110,10 @@ std::string FileOps::GetChannelIconPath(const MythChannel& channel)
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s: channel: %s", __FUNCTION__, uid.c_str());
 
-  // Check local directory
-  std::map<std::string, std::string>::iterator it = m_icons.find(uid);
-  if (it != m_icons.end())
-    return it->second;
-
-  // Determine filename
-  std::string localFilename = m_localBasePath + GetTypeNameByFileType(FileTypeChannelIcon) + PATH_SEPARATOR_CHAR + uid;
-  if (g_bExtraDebug)
-    XBMC->Log(LOG_DEBUG, "%s: determined localFilename: %s", __FUNCTION__, localFilename.c_str());
-
-  if (!CheckFile(localFilename))
-  {
-    CLockObject lock(m_lock);
-    FileOps::JobItem job(localFilename, FileTypeChannelIcon, channel);
-    m_jobQueue.push_back(job);
-    m_queueContent.Signal();
-  }
-  m_icons[uid] = localFilename;
-  return localFilename;
+  // The icon is downloaded again when the channel gets another one
+  FileOps::JobItem job(std::string(GetTypeNameByFileType(FileTypeChannelIcon)) + PATH_SEPARATOR_CHAR + uid,
+                       FileTypeChannelIcon, channel, channel.Icon());
+  return GetCachedFile(job);
 }
 
 std::string FileOps::GetPreviewIconPath(const MythProgramInfo& recording)
@@ -105,25 +127,10 @@ std::string FileOps::GetPreviewIconPath(const MythProgramInfo& recording)
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s: preview: %s", __FUNCTION__, uid.c_str());
 
-  // Check local directory
-  std::map<std::string, std::string>::iterator it = m_preview.find(uid);
-  if (it != m_preview.end())
-    return it->second;
-
-  // Determine local filename
-  std::string localFilename = m_localBasePath + GetTypeNameByFileType(FileTypeThumbnail) + PATH_SEPARATOR_CHAR + uid;
-  if (g_bExtraDebug)
-    XBMC->Log(LOG_DEBUG, "%s: determined localFilename: %s", __FUNCTION__, localFilename.c_str());
-
-  if (!CheckFile(localFilename))
-  {
-    CLockObject lock(m_lock);
-    FileOps::JobItem job(localFilename, FileTypeThumbnail, recording);
-    m_jobQueue.push_back(job);
-    m_queueContent.Signal();
-  }
-  m_preview[uid] = localFilename;
-  return localFilename;
+  // The preview is downloaded again for another recording at the same channel and time
+  FileOps::JobItem job(std::string(GetTypeNameByFileType(FileTypeThumbnail)) + PATH_SEPARATOR_CHAR + uid,
+                       FileTypeThumbnail, recording, Myth::IdToString(recording.RecordedID()));
+  return GetCachedFile(job);
 }
 
 std::string FileOps::GetArtworkPath(const MythProgramInfo& recording, FileType type)
@@ -144,26 +151,129 @@ std::string FileOps::GetArtworkPath(const MythProgramInfo& recording, FileType t
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s: %s: %s", __FUNCTION__, GetTypeNameByFileType(type), uid.c_str());
 
-  // Check local directory
-  std::pair<FileType, std::string> key = std::make_pair(type, uid);
-  std::map<std::pair<FileType, std::string>, std::string>::iterator iter = m_artworks.find(key);
-  if (iter != m_artworks.end())
-    return iter->second;
+  // The artwork is downloaded again when the metadata of the recording change
+  std::string validator(recording.Inetref());
+  validator.append(" ").append(Myth::IdToString(recording.Season()));
+  FileOps::JobItem job(std::string(GetTypeNameByFileType(type)) + PATH_SEPARATOR_CHAR + uid,
+                       type, recording, validator);
+  return GetCachedFile(job);
+}
 
-  // Determine local filename
-  std::string localFilename = m_localBasePath + GetTypeNameByFileType(type) + PATH_SEPARATOR_CHAR + uid.c_str();
+std::string FileOps::GetCachedFile(JobItem& job)
+{
+  job.m_localFilename = m_localBasePath + job.m_name;
   if (g_bExtraDebug)
-    XBMC->Log(LOG_DEBUG, "%s: determined localFilename: %s", __FUNCTION__, localFilename.c_str());
+    XBMC->Log(LOG_DEBUG, "%s: determined localFilename: %s", __FUNCTION__, job.m_localFilename.c_str());
 
-  if (!CheckFile(localFilename.c_str()))
+  CLockObject lock(m_lock);
+  CacheIndex::iterator it = m_index.find(job.m_name);
+  if (it != m_index.end())
   {
-    CLockObject lock(m_lock);
-    FileOps::JobItem job(localFilename, type, recording);
-    m_jobQueue.push_back(job);
-    m_queueContent.Signal();
+    if (it->second.validator == job.m_validator)
+    {
+      time_t now = time(NULL);
+      if (difftime(now, it->second.lastAccess) >= c_accessGranularity)
+      {
+        it->second.lastAccess = now;
+        m_indexModified = true;
+      }
+      return job.m_localFilename;
+    }
+    if (g_bExtraDebug)
+      XBMC->Log(LOG_DEBUG, "%s: Outdated file: %s", __FUNCTION__, job.m_localFilename.c_str());
+  }
+  else if (m_pendingFiles.find(job.m_localFilename) == m_pendingFiles.end() &&
+          m_failedFiles.find(job.m_localFilename) == m_failedFiles.end() &&
+          m_evictedFiles.find(job.m_localFilename) == m_evictedFiles.end())
+  {
+    // Index the file cached before the index existed
+    lock.Unlock();
+    int64_t size = CheckFile(job.m_localFilename);
+    lock.Lock();
+    if (size > 0)
+    {
+      StoreFile(job, size);
+      return job.m_localFilename;
+    }
+  }
+  if (m_failedFiles.find(job.m_localFilename) == m_failedFiles.end())
+    QueueJob(job);
+  return job.m_localFilename;
+}
+
+void FileOps::TouchFiles(const std::vector<std::string>& localFilenames, std::set<std::string>& evicted)
+{
+  time_t now = time(NULL);
+  CLockObject lock(m_lock);
+  for (std::vector<std::string>::const_iterator it = localFilenames.begin(); it != localFilenames.end(); ++it)
+  {
+    // Dummy icons are not in the cache
+    if (it->compare(0, m_localBasePath.size(), m_localBasePath) != 0)
+      continue;
+    CacheIndex::iterator entry = m_index.find(it->substr(m_localBasePath.size()));
+    if (entry != m_index.end())
+    {
+      if (difftime(now, entry->second.lastAccess) >= c_accessGranularity)
+      {
+        entry->second.lastAccess = now;
+        m_indexModified = true;
+      }
+    }
+    else if (m_evictedFiles.find(*it) != m_evictedFiles.end() && m_filesToDelete.find(*it) == m_filesToDelete.end())
+      evicted.insert(*it);
+  }
+}
+
+void FileOps::StoreFile(const JobItem& job, int64_t size)
+{
+  CLockObject lock(m_lock);
+  CacheIndex::iterator it = m_index.find(job.m_name);
+  if (it == m_index.end())
+    it = m_index.insert(std::make_pair(job.m_name, CacheEntry())).first;
+  else
+    m_indexSize -= it->second.size;
+  it->second.size = size;
+  it->second.lastAccess = time(NULL);
+  it->second.validator = job.m_validator;
+  m_indexSize += size;
+  m_indexModified = true;
+  EvictFiles();
+}
+
+void FileOps::EvictFiles()
+{
+  CLockObject lock(m_lock);
+  int64_t budget = (int64_t)g_iArtworkCacheSize * 1024 * 1024;
+  if (m_indexSize <= budget)
+    return;
+  // Leave some room, so that the next downloads don't evict again at once
+  budget -= budget / 10;
+
+  std::vector<std::pair<time_t, std::string> > lru;
+  lru.reserve(m_index.size());
+  for (CacheIndex::const_iterator it = m_index.begin(); it != m_index.end(); ++it)
+    lru.push_back(std::make_pair(it->second.lastAccess, it->first));
+  std::sort(lru.begin(), lru.end());
+
+  unsigned count = 0;
+  for (std::vector<std::pair<time_t, std::string> >::const_iterator it = lru.begin(); it != lru.end() && m_indexSize > budget; ++it)
+  {
+    std::string localFilename = m_localBasePath + it->second;
+    // The file is being refreshed
+    if (m_pendingFiles.find(localFilename) != m_pendingFiles.end())
+      continue;
+    m_filesToDelete.insert(localFilename);
+    m_evictedFiles.insert(localFilename);
+    CacheIndex::iterator entry = m_index.find(it->second);
+    m_indexSize -= entry->second.size;
+    m_index.erase(entry);
+    ++count;
   }
-  m_artworks[key] = localFilename;
-  return localFilename;
+  m_indexModified = true;
+  XBMC->Log(LOG_DEBUG, "%s: Evicted %u files, cache size is %" PRId64, __FUNCTION__, count, m_indexSize);
+  // The thread deletes the files out of the lock
+  if (count > 0)
+    m_queueContent.Signal();
 }
 
 void FileOps::Suspend()
@@ -176,6 +286,10 @@ void FileOps::Suspend()
     m_queueContent.Signal();
     StopThread(); // Wait for thread to stop
   }
+  StopWorkers();
+  CLockObject lock(m_lock);
+  if (m_indexModified)
+    SaveIndex();
 }
 
 void FileOps::Resume()
@@ -187,6 +301,7 @@ void FileOps::Resume()
     m_lock.Clear();
     CreateThread();
   }
+  StartWorkers();
 }
 
 void FileOps::CleanChannelIcons()
@@ -220,121 +335,241 @@ void FileOps::CleanChannelIcons()
     }
   }
 
-  // Clear the cached local filenames so that new cache jobs get generated
-  m_icons.clear();
+  // Drop the indexed icons so that new cache jobs get generated
+  std::string prefix = std::string(GetTypeNameByFileType(FileTypeChannelIcon)) + PATH_SEPARATOR_CHAR;
+  CacheIndex::iterator it3 = m_index.lower_bound(prefix);
+  while (it3 != m_index.end() && it3->first.compare(0, prefix.size(), prefix) == 0)
+  {
+    m_indexSize -= it3->second.size;
+    m_index.erase(it3++);
+  }
+  std::string localPrefix = m_localBasePath + prefix;
+  std::set<std::string>::iterator it4 = m_failedFiles.lower_bound(localPrefix);
+  while (it4 != m_failedFiles.end() && it4->compare(0, localPrefix.size(), localPrefix) == 0)
+    m_failedFiles.erase(it4++);
+  m_indexModified = true;
 }
 
 void *FileOps::Process()
 {
   XBMC->Log(LOG_DEBUG, "%s: FileOps Thread Started", __FUNCTION__);
 
-  std::list<FileOps::JobItem> jobQueueDelayed;
-
   while (!IsStopped())
   {
-    // Wake this thread from time to time to clean the cache and recache empty files (delayed queue)
-    // For caching new files, the tread is woken up by m_queueContent.Signal();
-    m_queueContent.Wait(c_timeoutProcess * 1000);
-
-    if (m_jobQueue.empty() && !IsStopped())
+    // Wake this thread from time to time to save the index and requeue the failed jobs when due
+    CLockObject lock(m_lock);
+    uint32_t wait = c_timeoutProcess * 1000;
+    if (!m_jobQueueDelayed.empty())
     {
-      if (m_localBaseStamp != FILEOPS_NOSTAMP && difftime(time(NULL), m_localBaseStamp) >= c_cacheMaxAge)
-      {
-        CleanCache();
-        if (m_consumer)
-          m_consumer->HandleCleanedCache();
-      }
+      double due = difftime(m_jobQueueDelayed.begin()->first, time(NULL));
+      if (due < c_timeoutProcess)
+        wait = (due > 0 ? (uint32_t)due * 1000 : 1);
     }
-
-    while (!m_jobQueue.empty() && !IsStopped())
+    lock.Unlock();
+    m_queueContent.Wait(wait);
+    if (IsStopped())
+      break;
+
+    lock.Lock();
+    time_t now = time(NULL);
+    bool requeued = false;
+    while (!m_jobQueueDelayed.empty() && m_jobQueueDelayed.begin()->first <= now)
     {
-      CLockObject lock(m_lock);
-      FileOps::JobItem job = m_jobQueue.front();
-      m_jobQueue.pop_front();
+      const JobItem& job = m_jobQueueDelayed.begin()->second;
+      m_jobQueue[GetJobPriority(job.m_fileType)].push_back(job);
+      m_jobQueueDelayed.erase(m_jobQueueDelayed.begin());
+      requeued = true;
+    }
+    if (m_indexModified && difftime(now, m_indexSaved) >= c_indexSaveDelay)
+      SaveIndex();
+    // The files stay listed until deleted, so that they are not queued meanwhile
+    std::set<std::string> files(m_filesToDelete);
+    lock.Unlock();
+    if (requeued)
+      m_jobReady.Broadcast();
+    if (!files.empty())
+    {
+      for (std::set<std::string>::const_iterator it = files.begin(); it != files.end(); ++it)
+        XBMC->DeleteFile(it->c_str());
+      lock.Lock();
+      for (std::set<std::string>::const_iterator it = files.begin(); it != files.end(); ++it)
+        m_filesToDelete.erase(*it);
       lock.Unlock();
+    }
+  }
 
-      if (g_bExtraDebug)
-        XBMC->Log(LOG_DEBUG,"%s: Job fetched: type: %d, local: %s", __FUNCTION__, job.m_fileType, job.m_localFilename.c_str());
-      // Try to open the destination file
-      void *file = OpenFile(job.m_localFilename);
-      if (!file)
-        continue;
-
-      // Connect to the stream
-      Myth::WSStreamPtr fileStream;
-      switch (job.m_fileType)
-      {
-      case FileTypeThumbnail:
-        fileStream = m_wsapi->GetPreviewImage(job.m_recording.ChannelID(), job.m_recording.RecordingStartTime());
-        break;
-      case FileTypeChannelIcon:
-        fileStream = m_wsapi->GetChannelIcon(job.m_channel.ID());
-        break;
-      case FileTypeCoverart:
-      case FileTypeFanart:
-        fileStream = m_wsapi->GetRecordingArtwork(GetTypeNameByFileType(job.m_fileType), job.m_recording.Inetref(), job.m_recording.Season());
-        break;
-      default:
-        break;
-      }
+  XBMC->Log(LOG_DEBUG, "%s: FileOps Thread Stopped", __FUNCTION__);
+  return NULL;
+}
 
-      if (fileStream)
-      {
-        // Cache it to the local addon cache
-        bool cached = CacheFile(file, fileStream.get());
-        XBMC->CloseFile(file);
-
-        if (cached)
-        {
-          if (g_bExtraDebug)
-            XBMC->Log(LOG_DEBUG, "%s: File Cached: type: %d, local: %s", __FUNCTION__, job.m_fileType, job.m_localFilename.c_str());
-        }
-        else
-        {
-          XBMC->Log(LOG_DEBUG, "%s: Caching file failed: type: %d, local: %s", __FUNCTION__, job.m_fileType, job.m_localFilename.c_str());
-          if (XBMC->FileExists(job.m_localFilename.c_str(), true))
-            XBMC->DeleteFile(job.m_localFilename.c_str());
-        }
-      }
-      else
-      {
-        XBMC->CloseFile(file);
-
-        // Failed to open file for reading. Unfortunately it cannot be determined if this is a permanent or a temporary problem (new recording's preview hasn't been generated yet).
-        // Increase the error count and retry to cache the file a few times
-        XBMC->Log(LOG_ERROR, "%s: Failed to read file: type: %d, local: %s", __FUNCTION__, job.m_fileType, job.m_localFilename.c_str());
-        job.m_errorCount += 1;
-
-        // Recache the file if it hasn't exceeded the maximum number of allowed attempts
-        if (job.m_errorCount <= c_maximumAttemptsOnReadError)
-        {
-          XBMC->Log(LOG_DEBUG, "%s: Delayed recache file: type: %d, local: %s", __FUNCTION__, job.m_fileType, job.m_localFilename.c_str());
-          jobQueueDelayed.push_back(job);
-        }
-      }
+FileOps::JobPriority FileOps::GetJobPriority(FileType fileType)
+{
+  switch (fileType)
+  {
+  case FileTypeChannelIcon:
+    return PriorityChannelIcon;
+  case FileTypeThumbnail:
+  case FileTypePreview:
+    return PriorityPreview;
+  default:
+    return PriorityArtwork;
+  }
+}
+
+void FileOps::StartWorkers()
+{
+  CLockObject lock(m_lock);
+  if (!m_workers.empty())
+    return;
+  for (unsigned i = 0; i < c_maximumWorkers; ++i)
+  {
+    Worker *worker = new Worker(*this);
+    if (worker->CreateThread())
+      m_workers.push_back(worker);
+    else
+      delete worker;
+  }
+  XBMC->Log(LOG_DEBUG, "%s: Started %u download workers", __FUNCTION__, (unsigned)m_workers.size());
+}
+
+void FileOps::StopWorkers()
+{
+  CLockObject lock(m_lock);
+  std::vector<Worker*> workers;
+  workers.swap(m_workers);
+  lock.Unlock();
+  for (std::vector<Worker*>::iterator it = workers.begin(); it != workers.end(); ++it)
+    (*it)->StopThread(-1); // Set stopping. don't wait as we need to signal the threads first
+  m_jobReady.Broadcast();
+  for (std::vector<Worker*>::iterator it = workers.begin(); it != workers.end(); ++it)
+  {
+    (*it)->StopThread(0); // Wait for thread to stop
+    delete *it;
+  }
+}
+
+void FileOps::QueueJob(const JobItem& job)
+{
+  CLockObject lock(m_lock);
+  // The evicted file is not deleted yet: it is queued once served again
+  if (m_filesToDelete.find(job.m_localFilename) != m_filesToDelete.end())
+    return;
+  // The file is already being cached
+  if (!m_pendingFiles.insert(job.m_localFilename).second)
+    return;
+  m_evictedFiles.erase(job.m_localFilename);
+  m_jobQueue[GetJobPriority(job.m_fileType)].push_back(job);
+  m_jobReady.Signal();
+}
+
+bool FileOps::ProcessNextJob()
+{
+  CLockObject lock(m_lock);
+  std::list<FileOps::JobItem> *queue = NULL;
+  for (int p = 0; p < PriorityCount && !queue; ++p)
+  {
+    if (!m_jobQueue[p].empty())
+      queue = &m_jobQueue[p];
+  }
+  if (!queue)
+    return false;
+  FileOps::JobItem job = queue->front();
+  queue->pop_front();
+  lock.Unlock();
+
+  if (g_bExtraDebug)
+    XBMC->Log(LOG_DEBUG,"%s: Job fetched: type: %d, local: %s", __FUNCTION__, job.m_fileType, job.m_localFilename.c_str());
+  int64_t size = 0;
+  bool done = DownloadJob(job, size);
+
+  lock.Lock();
+  if (!done)
+  {
+    // Failed to open file for reading. Unfortunately it cannot be determined if this is a permanent or a temporary problem (new recording's preview hasn't been generated yet).
+    // Increase the error count and retry to cache the file a few times, backing off
+    job.m_errorCount += 1;
+    if (job.m_errorCount <= c_maximumAttemptsOnReadError)
+    {
+      time_t delay = (time_t)c_retryDelay << (job.m_errorCount - 1);
+      XBMC->Log(LOG_DEBUG, "%s: Delayed recache file in %ds: type: %d, local: %s", __FUNCTION__, (int)delay, job.m_fileType, job.m_localFilename.c_str());
+      m_jobQueueDelayed.insert(std::make_pair(time(NULL) + delay, job));
+      lock.Unlock();
+      m_queueContent.Signal();
+      return true;
     }
+  }
+  m_pendingFiles.erase(job.m_localFilename);
+  if (size > 0)
+    StoreFile(job, size);
+  else
+    m_failedFiles.insert(job.m_localFilename);
+  return true;
+}
 
-    // Try to recache the currently empty files
-    CLockObject lock(m_lock);
-    m_jobQueue.insert(m_jobQueue.end(), jobQueueDelayed.begin(), jobQueueDelayed.end());
-    jobQueueDelayed.clear();
+bool FileOps::DownloadJob(const JobItem& job, int64_t& size)
+{
+  // Try to open the destination file
+  void *file = OpenFile(job.m_localFilename);
+  if (!file)
+    return true;
+
+  // Connect to the stream
+  Myth::WSStreamPtr fileStream;
+  switch (job.m_fileType)
+  {
+  case FileTypeThumbnail:
+    fileStream = m_wsapi->GetPreviewImage(job.m_recording.ChannelID(), job.m_recording.RecordingStartTime());
+    break;
+  case FileTypeChannelIcon:
+    fileStream = m_wsapi->GetChannelIcon(job.m_channel.ID());
+    break;
+  case FileTypeCoverart:
+  case FileTypeFanart:
+    fileStream = m_wsapi->GetRecordingArtwork(GetTypeNameByFileType(job.m_fileType), job.m_recording.Inetref(), job.m_recording.Season());
+    break;
+  default:
+    break;
   }
 
-  XBMC->Log(LOG_DEBUG, "%s: FileOps Thread Stopped", __FUNCTION__);
-  return NULL;
+  if (!fileStream)
+  {
+    XBMC->CloseFile(file);
+    XBMC->Log(LOG_ERROR, "%s: Failed to read file: type: %d, local: %s", __FUNCTION__, job.m_fileType, job.m_localFilename.c_str());
+    return false;
+  }
+
+  // Cache it to the local addon cache
+  bool cached = CacheFile(file, fileStream.get(), size);
+  XBMC->CloseFile(file);
+
+  if (cached)
+  {
+    if (g_bExtraDebug)
+      XBMC->Log(LOG_DEBUG, "%s: File Cached: type: %d, local: %s", __FUNCTION__, job.m_fileType, job.m_localFilename.c_str());
+  }
+  else
+  {
+    XBMC->Log(LOG_DEBUG, "%s: Caching file failed: type: %d, local: %s", __FUNCTION__, job.m_fileType, job.m_localFilename.c_str());
+    if (XBMC->FileExists(job.m_localFilename.c_str(), true))
+      XBMC->DeleteFile(job.m_localFilename.c_str());
+    size = 0;
+  }
+  return true;
 }
 
-bool FileOps::CheckFile(const std::string& localFilename)
+int64_t FileOps::CheckFile(const std::string& localFilename)
 {
-  bool ret = false;
+  int64_t size = 0;
   if (XBMC->FileExists(localFilename.c_str(), true))
   {
     void *file = XBMC->OpenFile(localFilename.c_str(), 0);
-    if (XBMC->GetFileLength(file) > 0)
-      ret = true;
-    XBMC->CloseFile(file);
+    if (file)
+    {
+      size = XBMC->GetFileLength(file);
+      XBMC->CloseFile(file);
+    }
   }
-  return ret;
+  return size;
 }
 
 void *FileOps::OpenFile(const std::string& localFilename)
@@ -365,10 +600,11 @@ void *FileOps::OpenFile(const std::string& localFilename)
   return file;
 }
 
-bool FileOps::CacheFile(void *file, Myth::Stream *source)
+bool FileOps::CacheFile(void *file, Myth::Stream *source, int64_t& size)
 {
   int s;
   char *buffer = new char[FILEOPS_STREAM_BUFFER_SIZE];
+  size = 0;
 
   while ((s = source->Read(buffer, FILEOPS_STREAM_BUFFER_SIZE)) > 0)
   {
@@ -381,6 +617,7 @@ bool FileOps::CacheFile(void *file, Myth::Stream *source)
 
       s -= bw;
       p += bw;
+      size += bw;
     } while (s > 0);
   }
   delete[] buffer;
@@ -393,46 +630,6 @@ bool FileOps::CacheFile(void *file, Myth::Stream *source)
   return true;
 }
 
-static void WriteCacheStamp(const char *path, time_t ts)
-{
-  void * hdl = XBMC->OpenFileForWrite(path, true);
-  if (hdl == NULL)
-  {
-    XBMC->Log(LOG_ERROR,"%s: Write stamp file %s failed", __FUNCTION__, path);
-    return;
-  }
-  std::string now(Myth::TimeToString(ts, true));
-  XBMC->WriteFile(hdl, now.c_str(), now.length());
-  XBMC->CloseFile(hdl);
-}
-
-static time_t ReadCacheStamp(const char *path)
-{
-  time_t ts = FILEOPS_NOSTAMP;
-  char buf[21]; // Time string as ISO-8601/UTC: %y-%m-%d"T"%H:%M:%S"Z"
-  memset(buf, 0, sizeof(buf));
-  void * hdl = XBMC->OpenFile(path, 0);
-  if (hdl == NULL)
-  {
-    XBMC->Log(LOG_ERROR,"%s: Read stamp file %s failed", __FUNCTION__, path);
-    // Try write a new one
-    ts = time(NULL);
-    WriteCacheStamp(path, ts);
-    return ts;
-  }
-  if (XBMC->ReadFile(hdl, (void*)buf, (int64_t)(sizeof(buf) - 1)))
-    ts = Myth::StringToTime(buf); // It returns FILEOPS_NOSTAMP for invalid buf
-  XBMC->CloseFile(hdl);
-  // If stamp is invalid we overwrite it
-  if (ts == FILEOPS_NOSTAMP)
-  {
-    XBMC->Log(LOG_ERROR,"%s: Bad stamp string '%s'", __FUNCTION__, buf);
-    ts = time(NULL);
-    WriteCacheStamp(path, ts);
-  }
-  return ts;
-}
-
 void FileOps::InitBasePath()
 {
   XBMC->Log(LOG_DEBUG, "%s: Configure cache directory %s", __FUNCTION__, m_localBasePath.c_str());
@@ -445,54 +642,110 @@ void FileOps::InitBasePath()
     XBMC->Log(LOG_ERROR,"%s: Failed to create cache directory %s", __FUNCTION__, m_localBasePath.c_str());
     return;
   }
-  if (!XBMC->FileExists(m_localBaseStampName.c_str(), false))
+  LoadIndex();
+  EvictFiles();
+}
+
+void FileOps::LoadIndex()
+{
+  if (!XBMC->FileExists(m_indexFilename.c_str(), false))
+    return;
+  void *file = XBMC->OpenFile(m_indexFilename.c_str(), 0);
+  if (!file)
   {
-    m_localBaseStamp = time(NULL);
-    WriteCacheStamp(m_localBaseStampName.c_str(), m_localBaseStamp);
+    XBMC->Log(LOG_ERROR, "%s: Failed to open index %s", __FUNCTION__, m_indexFilename.c_str());
     return;
   }
-  m_localBaseStamp = ReadCacheStamp(m_localBaseStampName.c_str());
-  XBMC->Log(LOG_DEBUG,"%s: Cache stamp is %s", __FUNCTION__, ctime(&m_localBaseStamp));
-  if (difftime(time(NULL), m_localBaseStamp) >= c_cacheMaxAge)
-    CleanCache();
+  std::string buf;
+  char *chunk = new char[FILEOPS_STREAM_BUFFER_SIZE];
+  ssize_t s;
+  while ((s = XBMC->ReadFile(file, chunk, FILEOPS_STREAM_BUFFER_SIZE)) > 0)
+    buf.append(chunk, (size_t)s);
+  delete[] chunk;
+  XBMC->CloseFile(file);
+
+  // Text lines: header "MYTHARTWORK <version>", then
+  // "<size> <last access> <name> <validator>" per file
+  size_t pos = 0;
+  bool header = true;
+  while (pos < buf.size())
+  {
+    size_t eol = buf.find('\n', pos);
+    if (eol == std::string::npos)
+      eol = buf.size();
+    std::string line(buf, pos, eol - pos);
+    pos = eol + 1;
+    if (header)
+    {
+      char magic[16];
+      int version = 0;
+      if (sscanf(line.c_str(), "%15s %d", magic, &version) < 2 || std::string(magic) != FILEOPS_INDEX_MAGIC ||
+              version != FILEOPS_INDEX_VERSION)
+      {
+        XBMC->Log(LOG_NOTICE, "%s: Index has unknown format", __FUNCTION__);
+        return;
+      }
+      header = false;
+      continue;
+    }
+    long long size = 0, lastAccess = 0;
+    char name[256];
+    int n = 0;
+    if (sscanf(line.c_str(), "%lld %lld %255s %n", &size, &lastAccess, name, &n) < 3 || size <= 0)
+      continue;
+    // The file was removed behind our back
+    std::string localFilename = m_localBasePath + name;
+    if (!XBMC->FileExists(localFilename.c_str(), true))
+      continue;
+    CacheEntry& entry = m_index[name];
+    entry.size = (int64_t)size;
+    entry.lastAccess = (time_t)lastAccess;
+    entry.validator = (n > 0 ? line.substr(n) : std::string());
+    m_indexSize += entry.size;
+  }
+  XBMC->Log(LOG_DEBUG, "%s: Loaded %u files, cache size is %" PRId64, __FUNCTION__, (unsigned)m_index.size(), m_indexSize);
 }
 
-void FileOps::CleanCache()
+bool FileOps::SaveIndex()
 {
-  // Currently XBMC's addon lib doesn't provide a way to list files in a directory.
-  // Therefore we currently can't clean only leftover files.
-
-  XBMC->Log(LOG_DEBUG, "%s: Cleaning cache %s", __FUNCTION__, m_localBasePath.c_str());
-
   CLockObject lock(m_lock);
+  std::string buf;
+  char line[64];
+  snprintf(line, sizeof(line), "%s %d\n", FILEOPS_INDEX_MAGIC, FILEOPS_INDEX_VERSION);
+  buf.append(line);
+  for (CacheIndex::const_iterator it = m_index.begin(); it != m_index.end(); ++it)
+  {
+    snprintf(line, sizeof(line), "%lld %lld ", (long long)it->second.size, (long long)it->second.lastAccess);
+    buf.append(line).append(it->first).append(" ").append(it->second.validator).append("\n");
+  }
+  m_indexModified = false;
+  m_indexSaved = time(NULL);
 
-  // Remove cache sub directories
-  std::vector<FileType>::const_iterator it;
-  std::vector<FileType> fileTypes = GetFileTypes();
-  std::vector<std::string> directories;
-  for (it = fileTypes.begin(); it != fileTypes.end(); ++it)
+  void *file = XBMC->OpenFileForWrite(m_indexFilename.c_str(), true);
+  if (!file)
   {
-    std::string directory(GetTypeNameByFileType(*it));
-    if (!directory.empty() && *it != FileTypeChannelIcon)
-      directories.push_back(m_localBasePath + directory);
+    XBMC->Log(LOG_ERROR, "%s: Failed to create index %s", __FUNCTION__, m_indexFilename.c_str());
+    return false;
   }
-  std::vector<std::string>::const_iterator it2;
-  for (it2 = directories.begin(); it2 != directories.end(); ++it2)
+  const char *p = buf.data();
+  size_t s = buf.size();
+  while (s > 0)
   {
-    if (XBMC->DirectoryExists(it2->c_str()) && !XBMC->RemoveDirectory(it2->c_str()))
-    {
-      XBMC->Log(LOG_ERROR,"%s: Failed to remove cache sub directory %s", __FUNCTION__, it2->c_str());
-    }
+    ssize_t bw = XBMC->WriteFile(file, p, s);
+    if (bw <= 0)
+      break;
+    s -= (size_t)bw;
+    p += bw;
   }
-
-  // Clear the cached local filenames so that new cache jobs get generated
-  m_preview.clear();
-  m_artworks.clear();
-
-  // Reset stamp file
-  m_localBaseStamp = time(NULL);
-  WriteCacheStamp(m_localBaseStampName.c_str(), m_localBaseStamp);
-  XBMC->Log(LOG_DEBUG, "%s: New cache stamp is %s", __FUNCTION__, ctime(&m_localBaseStamp));
+  XBMC->CloseFile(file);
+  if (s > 0)
+  {
+    XBMC->Log(LOG_ERROR, "%s: Failed to write index %s", __FUNCTION__, m_indexFilename.c_str());
+    XBMC->DeleteFile(m_indexFilename.c_str());
+    return false;
+  }
+  XBMC->Log(LOG_DEBUG, "%s: Saved %u files", __FUNCTION__, (unsigned)m_index.size());
+  return true;
 }
 
 std::string FileOps::GetFileName(const std::string& path, char separator)
@@ -31,14 +31,17 @@
 #include <vector>
 #include <list>
 #include <map>
-
-class FileConsumer
-{
-public:
-  virtual ~FileConsumer() {};
-  virtual void HandleCleanedCache() = 0;
-};
-
+#include <set>
+
+/**
+ * Cache of the artworks downloaded from the backend, stored in the user path.
+ * A persistent index keeps the size, the last access and a validator of each
+ * file, so a lookup needs no file access. The validator is what the file was
+ * downloaded from (icon path, inetref and season, recorded id): the file is
+ * downloaded again when it changes. The least recently used files are evicted
+ * when the cache grows over the configured size. An evicted file is queued
+ * again only once it is served again.
+ */
 class FileOps : public P8PLATFORM::CThread
 {
 public:
@@ -93,15 +96,21 @@ public:
 
   static const int c_timeoutProcess              = 10;       // Wake the thread every 10s
   static const int c_maximumAttemptsOnReadError  = 3;        // Retry when reading file failed
-  static const int c_cacheMaxAge                 = 2635200;  // Clean cache every 2635200s (30.5 days)
+  static const int c_retryDelay                  = 10;       // First retry after 10s, the delay doubles on each failure
+  static const unsigned c_maximumWorkers         = 4;        // Concurrent downloads from the backend
+  static const int c_indexSaveDelay              = 60;       // Save the modified index at most every 60s
+  static const int c_accessGranularity           = 3600;     // Record the last access of a file within 1h
 
-  FileOps(FileConsumer *consumer, const std::string& server, unsigned wsapiport, const std::string& wsapiSecurityPin);
+  FileOps(const std::string& server, unsigned wsapiport, const std::string& wsapiSecurityPin);
   virtual ~FileOps();
 
   std::string GetChannelIconPath(const MythChannel& channel);
   std::string GetPreviewIconPath(const MythProgramInfo& recording);
   std::string GetArtworkPath(const MythProgramInfo& recording, FileType type);
 
+  /// Record the access of files served without lookup. Served files evicted since are returned in evicted.
+  void TouchFiles(const std::vector<std::string>& localFilenames, std::set<std::string>& evicted);
+
   void Suspend();
   void Resume();
 
@@ -110,49 +119,89 @@ public:
 protected:
   void *Process();
 
-  bool CheckFile(const std::string &localFilename);
+  class Worker;
+
+  enum JobPriority
+  {
+    PriorityChannelIcon = 0,
+    PriorityPreview,
+    PriorityArtwork,
+    PriorityCount
+  };
+
+  static JobPriority GetJobPriority(FileType fileType);
+
+  int64_t CheckFile(const std::string &localFilename);
   void *OpenFile(const std::string &localFilename);
-  bool CacheFile(void *file, Myth::Stream *source);
+  bool CacheFile(void *file, Myth::Stream *source, int64_t& size);
   void InitBasePath();
-  void CleanCache();
+  void StartWorkers();
+  void StopWorkers();
 
   static std::string GetFileName(const std::string& path, char separator = PATH_SEPARATOR_CHAR);
   static std::string GetDirectoryName(const std::string& path, char separator = PATH_SEPARATOR_CHAR);
 
-  std::map<std::string, std::string> m_icons;
-  std::map<std::string, std::string> m_preview;
-  std::map<std::pair<FileType, std::string>, std::string> m_artworks;
-
-  FileConsumer *m_consumer;
   Myth::WSAPI *m_wsapi;
   std::string m_localBasePath;
-  std::string m_localBaseStampName;
-  time_t m_localBaseStamp;
+  std::string m_indexFilename;
 
   struct JobItem {
-    JobItem(const std::string& localFilename, FileType type, const MythProgramInfo& recording)
-    : m_localFilename(localFilename)
+    JobItem(const std::string& name, FileType type, const MythProgramInfo& recording, const std::string& validator)
+    : m_name(name)
     , m_fileType(type)
     , m_recording(recording)
+    , m_validator(validator)
     , m_errorCount(0)
     {
     }
-    JobItem(const std::string& localFilename, FileType type, const MythChannel& channel)
-    : m_localFilename(localFilename)
+    JobItem(const std::string& name, FileType type, const MythChannel& channel, const std::string& validator)
+    : m_name(name)
     , m_fileType(type)
     , m_channel(channel)
+    , m_validator(validator)
     , m_errorCount(0)
     {
     }
 
+    std::string     m_name;           ///< Path relative to the cache directory
     std::string     m_localFilename;
     FileType        m_fileType;
     MythProgramInfo m_recording;
     MythChannel     m_channel;
+    std::string     m_validator;
     int             m_errorCount;
   };
 
+  struct CacheEntry
+  {
+    int64_t size;
+    time_t lastAccess;
+    std::string validator;
+  };
+  typedef std::map<std::string, CacheEntry> CacheIndex;
+
+  std::string GetCachedFile(JobItem& job);
+  void StoreFile(const JobItem& job, int64_t size);
+  void EvictFiles();
+  void LoadIndex();
+  bool SaveIndex();
+
+  void QueueJob(const JobItem& job);
+  bool ProcessNextJob();
+  bool DownloadJob(const JobItem& job, int64_t& size);
+
   P8PLATFORM::CMutex m_lock;
   P8PLATFORM::CEvent m_queueContent;
-  std::list<FileOps::JobItem> m_jobQueue;
+  P8PLATFORM::CEvent m_jobReady;
+  std::list<FileOps::JobItem> m_jobQueue[PriorityCount];
+  std::multimap<time_t, FileOps::JobItem> m_jobQueueDelayed;  ///< Failed jobs by time of retry
+  std::set<std::string> m_pendingFiles;                       ///< Local files of the queued, running or delayed jobs
+  std::set<std::string> m_failedFiles;                        ///< Not downloaded again during the session
+  std::vector<Worker*> m_workers;
+  CacheIndex m_index;
+  int64_t m_indexSize;                                        ///< Total size of the indexed files
+  bool m_indexModified;
+  time_t m_indexSaved;
+  std::set<std::string> m_evictedFiles;                       ///< Local files evicted and not queued again since
+  std::set<std::string> m_filesToDelete;                      ///< Evicted files, deleted by the thread out of the lock
 };
@@ -0,0 +1,253 @@
+/*
+ *      Copyright (C) 2005-2014 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301 USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "guideIndex.h"
+
+#include <set>
+#include <algorithm>
+#include <cctype>
+
+using namespace P8PLATFORM;
+
+namespace
+{
+  struct ProgramStartOrder
+  {
+    bool operator()(const Myth::ProgramPtr& a, const Myth::ProgramPtr& b) const
+    {
+      if (a->startTime != b->startTime)
+        return a->startTime < b->startTime;
+      return a->channel.chanId < b->channel.chanId;
+    }
+  };
+}
+
+GuideIndex::GuideIndex()
+: m_lock()
+, m_docs()
+, m_dropped(0)
+, m_tokens()
+, m_guide()
+{
+}
+
+void GuideIndex::Clear()
+{
+  CLockObject lock(m_lock);
+  m_docs.clear();
+  m_dropped = 0;
+  m_tokens.clear();
+  m_guide.clear();
+}
+
+void GuideIndex::Tokenize(const std::string& text, std::vector<std::string>& tokens)
+{
+  // Words are runs of alphanumerics, bytes of multibyte characters included
+  std::string token;
+  for (std::string::const_iterator it = text.begin(); it != text.end(); ++it)
+  {
+    unsigned char c = static_cast<unsigned char>(*it);
+    if (c >= 0x80 || isalnum(c))
+      token.push_back(c < 0x80 ? static_cast<char>(tolower(c)) : *it);
+    else if (!token.empty())
+    {
+      tokens.push_back(token);
+      token.clear();
+    }
+  }
+  if (!token.empty())
+    tokens.push_back(token);
+}
+
+void GuideIndex::IndexField(uint32_t doc, Field field, const std::string& text)
+{
+  std::vector<std::string> tokens;
+  Tokenize(text, tokens);
+  for (std::vector<std::string>::size_type i = 0; i < tokens.size() && i <= 0xFFFF; ++i)
+  {
+    Posting posting = { doc, static_cast<uint16_t>(field), static_cast<uint16_t>(i) };
+    m_tokens[tokens[i]].push_back(posting);
+  }
+}
+
+void GuideIndex::Drop(ChannelGuide& guide, ChannelGuide::iterator first, ChannelGuide::iterator last)
+{
+  for (ChannelGuide::iterator it = first; it != last; ++it)
+  {
+    m_docs[it->second].reset();
+    ++m_dropped;
+  }
+  guide.erase(first, last);
+}
+
+void GuideIndex::Compact()
+{
+  std::vector<Myth::ProgramPtr> docs;
+  docs.reserve(m_docs.size() - m_dropped);
+  m_tokens.clear();
+  for (GuideMap::iterator itc = m_guide.begin(); itc != m_guide.end(); ++itc)
+  {
+    for (ChannelGuide::iterator it = itc->second.begin(); it != itc->second.end(); ++it)
+    {
+      uint32_t doc = static_cast<uint32_t>(docs.size());
+      docs.push_back(m_docs[it->second]);
+      it->second = doc;
+      const Myth::Program& program = *(docs.back());
+      IndexField(doc, FieldTitle, program.title);
+      IndexField(doc, FieldSubtitle, program.subTitle);
+      IndexField(doc, FieldDescription, program.description);
+      IndexField(doc, FieldCategory, program.category);
+    }
+  }
+  m_docs.swap(docs);
+  m_dropped = 0;
+}
+
+void GuideIndex::Store(uint32_t chanid, time_t start, time_t end, const Myth::ProgramMap& guide)
+{
+  time_t now = time(NULL);
+  CLockObject lock(m_lock);
+  ChannelGuide& channel = m_guide[chanid];
+
+  // Drop the programs of the window and the ended ones
+  if (start <= end)
+  {
+    ChannelGuide::iterator first = channel.lower_bound(start);
+    if (first != channel.begin())
+    {
+      ChannelGuide::iterator prev = first;
+      --prev;
+      if (m_docs[prev->second]->endTime > start)
+        first = prev;
+    }
+    Drop(channel, first, channel.upper_bound(end));
+  }
+  ChannelGuide::iterator last = channel.begin();
+  while (last != channel.end() && m_docs[last->second]->endTime < now)
+    ++last;
+  Drop(channel, channel.begin(), last);
+
+  for (Myth::ProgramMap::const_iterator it = guide.begin(); it != guide.end(); ++it)
+  {
+    // Reject bad entry
+    if (!it->second || it->second->endTime <= it->first || it->second->endTime < now)
+      continue;
+    ChannelGuide::iterator itg = channel.find(it->first);
+    if (itg != channel.end())
+    {
+      ChannelGuide::iterator next = itg;
+      Drop(channel, itg, ++next);
+    }
+    uint32_t doc = static_cast<uint32_t>(m_docs.size());
+    m_docs.push_back(it->second);
+    channel.insert(ChannelGuide::value_type(it->first, doc));
+    IndexField(doc, FieldTitle, it->second->title);
+    IndexField(doc, FieldSubtitle, it->second->subTitle);
+    IndexField(doc, FieldDescription, it->second->description);
+    IndexField(doc, FieldCategory, it->second->category);
+  }
+  if (channel.empty())
+    m_guide.erase(chanid);
+
+  if (m_dropped > c_compactThreshold && m_dropped > m_docs.size() - m_dropped)
+    Compact();
+}
+
+Myth::ProgramPtr GuideIndex::Find(uint32_t chanid, time_t attime) const
+{
+  CLockObject lock(m_lock);
+  GuideMap::const_iterator itc = m_guide.find(chanid);
+  if (itc == m_guide.end())
+    return Myth::ProgramPtr();
+  // The last program started at the given time
+  ChannelGuide::const_iterator it = itc->second.upper_bound(attime);
+  if (it == itc->second.begin())
+    return Myth::ProgramPtr();
+  --it;
+  const Myth::ProgramPtr& program = m_docs[it->second];
+  if (it->first == attime || program->endTime > attime)
+    return program;
+  return Myth::ProgramPtr();
+}
+
+Myth::ProgramList GuideIndex::Search(const std::string& query, unsigned fields, uint32_t chanid) const
+{
+  Myth::ProgramList found;
+  std::vector<std::string> words;
+  Tokenize(query, words);
+  if (words.empty())
+    return found;
+
+  time_t now = time(NULL);
+  CLockObject lock(m_lock);
+  // Matches are keyed by program, field and position of the first word of the phrase
+  typedef std::pair<uint32_t, std::pair<uint16_t, int> > Match;
+  std::set<Match> matches;
+  for (std::vector<std::string>::size_type i = 0; i < words.size(); ++i)
+  {
+    std::set<Match> next;
+    const std::string& word = words[i];
+    TokenMap::const_iterator it = m_tokens.lower_bound(word);
+    TokenMap::const_iterator end = it;
+    if (i + 1 < words.size())
+    {
+      if (it != m_tokens.end() && it->first == word)
+        ++end;
+    }
+    else
+    {
+      while (end != m_tokens.end() && end->first.compare(0, word.size(), word) == 0)
+        ++end;
+    }
+    for (; it != end; ++it)
+    {
+      for (PostingList::const_iterator itp = it->second.begin(); itp != it->second.end(); ++itp)
+      {
+        if (!(itp->field & fields))
+          continue;
+        Match match(itp->doc, std::make_pair(itp->field, static_cast<int>(itp->position) - static_cast<int>(i)));
+        if (i == 0)
+        {
+          const Myth::ProgramPtr& program = m_docs[itp->doc];
+          if (program && program->endTime > now && (chanid == 0 || program->channel.chanId == chanid))
+            next.insert(match);
+        }
+        else if (matches.find(match) != matches.end())
+          next.insert(match);
+      }
+    }
+    matches.swap(next);
+    if (matches.empty())
+      return found;
+  }
+
+  uint32_t last = static_cast<uint32_t>(-1);
+  for (std::set<Match>::const_iterator it = matches.begin(); it != matches.end(); ++it)
+  {
+    if (it->first == last)
+      continue;
+    last = it->first;
+    found.push_back(m_docs[last]);
+  }
+  std::sort(found.begin(), found.end(), ProgramStartOrder());
+  return found;
+}
@@ -0,0 +1,87 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2014 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301 USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <mythtypes.h>
+#include <p8-platform/threads/mutex.h>
+
+#include <string>
+#include <vector>
+#include <map>
+
+/**
+ * Local copy of the program guide transferred to Kodi, with an inverted index
+ * over the titles, subtitles, descriptions and categories. It resolves the
+ * program of a broadcast and previews the airings matched by a search rule
+ * without requesting the backend. The guide of a channel is replaced window by
+ * window as Kodi requests it, and the ended programs are dropped.
+ */
+class GuideIndex
+{
+public:
+  enum Field
+  {
+    FieldTitle        = 0x1,
+    FieldSubtitle     = 0x2,
+    FieldDescription  = 0x4,
+    FieldCategory     = 0x8,
+  };
+
+  GuideIndex();
+
+  void Clear();
+  /// Replace the programs of the channel airing between start and end by the given guide
+  void Store(uint32_t chanid, time_t start, time_t end, const Myth::ProgramMap& guide);
+  /// Find the program airing on the channel at the given time. Returns a null pointer when unknown.
+  Myth::ProgramPtr Find(uint32_t chanid, time_t attime) const;
+  /**
+   * Find the programs not yet ended whose given fields contain the words of
+   * the query as a phrase. The last word matches as a prefix. Any channel
+   * matches when chanid is 0. Programs are ordered by start time.
+   */
+  Myth::ProgramList Search(const std::string& query, unsigned fields, uint32_t chanid = 0) const;
+
+private:
+  static const unsigned c_compactThreshold = 1024;  // Rebuild the index when dropped programs exceed this count and the kept ones
+
+  struct Posting
+  {
+    uint32_t doc;
+    uint16_t field;
+    uint16_t position;
+  };
+  typedef std::vector<Posting> PostingList;
+  typedef std::map<std::string, PostingList> TokenMap;
+  typedef std::map<time_t, uint32_t> ChannelGuide;        ///< Start time to program
+  typedef std::map<uint32_t, ChannelGuide> GuideMap;        ///< Channel id to its guide
+
+  static void Tokenize(const std::string& text, std::vector<std::string>& tokens);
+  void IndexField(uint32_t doc, Field field, const std::string& text);
+  void Drop(ChannelGuide& guide, ChannelGuide::iterator first, ChannelGuide::iterator last);
+  void Compact();
+
+  mutable P8PLATFORM::CMutex m_lock;
+  std::vector<Myth::ProgramPtr> m_docs;   ///< Indexed programs. A dropped program is reset.
+  unsigned m_dropped;
+  TokenMap m_tokens;
+  GuideMap m_guide;
+};
@@ -23,7 +23,6 @@
 #include "pvrclient-mythtv.h"
 #include "client.h"
 #include "tools.h"
-#include "avinfo.h"
 
 #include <time.h>
 #include <set>
@@ -43,22 +42,44 @@ PVRClientMythTV::PVRClientMythTV()
 , m_powerSaving(false)
 , m_fileOps(NULL)
 , m_scheduleManager(NULL)
+, m_scheduleUpdater(NULL)
+, m_channels(new ChannelsData())
+, m_recordings(new ProgramInfoMap())
 , m_recordingChangePinCount(0)
-, m_recordingsAmountChange(false)
-, m_recordingsAmount(0)
-, m_deletedRecAmountChange(false)
-, m_deletedRecAmount(0)
+, m_recordingsMerged(false)
+, m_recordingsIndex()
+, m_recordingsSnapshot(NULL)
+, m_recordingTagGeneration(0)
+, m_recordingsJournal(NULL)
+, m_avinfoCache(NULL)
+, m_edlCache(NULL)
 {
 }
 
 PVRClientMythTV::~PVRClientMythTV()
 {
+  // The prober opens its playback through the event handler
+  SAFE_DELETE(m_avinfoCache);
+  // Stop receiving events before releasing the journal
+  if (m_eventHandler)
+    m_eventHandler->Stop();
+  SAFE_DELETE(m_recordingsJournal);
+  SAFE_DELETE(m_scheduleUpdater);
   SAFE_DELETE(m_dummyStream);
   SAFE_DELETE(m_liveStream);
   SAFE_DELETE(m_recordingStream);
   SAFE_DELETE(m_fileOps);
   SAFE_DELETE(m_scheduleManager);
   SAFE_DELETE(m_eventHandler);
+  if (m_recordingsSnapshot)
+  {
+    // Keep the recordings for the next start
+    CLockObject lock(m_recordingsLock);
+    m_recordingsSnapshot->Save(*m_recordings);
+    lock.Unlock();
+    SAFE_DELETE(m_recordingsSnapshot);
+  }
+  SAFE_DELETE(m_edlCache);
   SAFE_DELETE(m_control);
 }
 
@@ -147,11 +168,33 @@ bool PVRClientMythTV::Connect()
 
   // Create schedule manager and new subscription handled by dedicated thread
   m_scheduleManager = new MythScheduleManager(g_szMythHostname, g_iProtoPort, g_iWSApiPort, g_szWSSecurityPin);
+  m_scheduleUpdater = new ScheduleUpdater(this);
   subid = m_eventHandler->CreateSubscription(this);
   m_eventHandler->SubscribeForEvent(subid, Myth::EVENT_SCHEDULE_CHANGE);
 
+  // The guide kept from a previous connection could be outdated
+  m_guideIndex.Clear();
+
   // Create file operation helper (image caching)
-  m_fileOps = new FileOps(this, g_szMythHostname, g_iWSApiPort, g_szWSSecurityPin);
+  m_fileOps = new FileOps(g_szMythHostname, g_iWSApiPort, g_szWSSecurityPin);
+
+  // Serve the recordings from the last snapshot until the event handler gets
+  // connected and the recorded list is merged
+  m_recordingsSnapshot = new RecordingsSnapshot(m_control->GetServerHostName(), m_control->CheckService());
+  {
+    CLockObject lock(m_recordingsLock);
+    if (m_recordingsSnapshot->Load(EditRecordings()))
+      m_recordingsIndex.Rebuild(*m_recordings);
+  }
+
+  // Create cache of recording marks
+  m_edlCache = new EdlCache(*m_control);
+
+  // Create journal of recording changes
+  m_recordingsJournal = new RecordingsJournal(this);
+
+  // Create cache of AV properties
+  m_avinfoCache = new AVInfoCache(this, *m_eventHandler, m_control->GetServerHostName());
 
   // Start event handler
   m_eventHandler->Start();
@@ -223,6 +266,8 @@ void PVRClientMythTV::OnSleep()
 {
   if (m_fileOps)
     m_fileOps->Suspend();
+  if (m_avinfoCache)
+    m_avinfoCache->Suspend();
   if (m_eventHandler)
     m_eventHandler->Stop();
   if (m_scheduleManager)
@@ -241,6 +286,8 @@ void PVRClientMythTV::OnWake()
     m_eventHandler->Start();
   if (m_fileOps)
     m_fileOps->Resume();
+  if (m_avinfoCache)
+    m_avinfoCache->Resume();
 }
 
 void PVRClientMythTV::OnDeactivatedGUI()
@@ -262,7 +309,8 @@ void PVRClientMythTV::HandleBackendMessage(Myth::EventMessagePtr msg)
   switch (msg->event)
   {
     case Myth::EVENT_SCHEDULE_CHANGE:
-      HandleScheduleChange();
+      if (m_scheduleUpdater)
+        m_scheduleUpdater->PushChange();
       break;
     case Myth::EVENT_ASK_RECORDING:
       HandleAskRecording(*msg);
@@ -314,18 +362,36 @@ void PVRClientMythTV::HandleBackendMessage(Myth::EventMessagePtr msg)
 void PVRClientMythTV::HandleChannelChange()
 {
   FillChannelsAndChannelGroups();
+  // The guide of removed channels must not be searched, Kodi fetches it again
+  m_guideIndex.Clear();
+  {
+    // Recording tags refer to channel uids
+    CLockObject lock(m_recordingsLock);
+    ++m_recordingTagGeneration;
+  }
   PVR->TriggerChannelUpdate();
   PVR->TriggerChannelGroupsUpdate();
 }
 
-void PVRClientMythTV::HandleScheduleChange()
+void PVRClientMythTV::HandleScheduleChange(bool forceUpdate)
 {
   if (!m_scheduleManager)
     return;
-  m_scheduleManager->Update();
+  MythTimerIndexSet changes = m_scheduleManager->Update();
+  if (changes.empty() && !forceUpdate)
+  {
+    if (g_bExtraDebug)
+      XBMC->Log(LOG_DEBUG, "%s: Schedule is unchanged", __FUNCTION__);
+    return;
+  }
   PVR->TriggerTimerUpdate();
 }
 
+void PVRClientMythTV::HandleScheduleUpdate()
+{
+  HandleScheduleChange(false);
+}
+
 void PVRClientMythTV::HandleAskRecording(const Myth::EventMessage& msg)
 {
   if (!m_control)
@@ -371,123 +437,177 @@ void PVRClientMythTV::HandleAskRecording(const Myth::EventMessage& msg)
 
 void PVRClientMythTV::HandleRecordingListChange(const Myth::EventMessage& msg)
 {
-  if (!m_control)
+  if (!m_recordingsJournal)
     return;
+  // Changes are collected by the journal and resolved on its own thread
   unsigned cs = (unsigned)msg.subject.size();
   if (cs <= 1)
+    m_recordingsJournal->PushReload();
+  else if (cs == 4 && msg.subject[1] == "ADD")
+    m_recordingsJournal->PushAdd(Myth::StringToId(msg.subject[2]), Myth::StringToTime(msg.subject[3]));
+  else if (cs == 3 && msg.subject[1] == "ADD")
+    m_recordingsJournal->PushAdd(Myth::StringToId(msg.subject[2]));
+  else if (cs == 2 && msg.subject[1] == "UPDATE" && msg.program)
+    m_recordingsJournal->PushUpdate(msg.program);
+  else if (cs == 4 && msg.subject[1] == "DELETE")
+    m_recordingsJournal->PushDelete(Myth::StringToId(msg.subject[2]), Myth::StringToTime(msg.subject[3]));
+  else if (cs == 3 && msg.subject[1] == "DELETE")
+    m_recordingsJournal->PushDelete(Myth::StringToId(msg.subject[2]));
+}
+
+void PVRClientMythTV::HandleRecordingReload()
+{
+  if (g_bExtraDebug)
+    XBMC->Log(LOG_DEBUG, "%s: Resync all recordings", __FUNCTION__);
+  // The list is fetched without holding the recordings
+  if (FillRecordings() > 0)
   {
-    if (g_bExtraDebug)
-      XBMC->Log(LOG_DEBUG, "%s: Reload all recordings", __FUNCTION__);
     CLockObject lock(m_recordingsLock);
-    FillRecordings();
     ++m_recordingChangePinCount;
   }
-  else if (cs == 4 && msg.subject[1] == "ADD")
+}
+
+void PVRClientMythTV::HandleRecordingChanges(const RecordingChangeList& changes)
+{
+  if (!m_control)
+    return;
+
+  // A burst of additions is resolved at once with the paged recorded list
+  unsigned adds = 0;
+  for (RecordingChangeList::const_iterator it = changes.begin(); it != changes.end(); ++it)
   {
-    uint32_t chanid = Myth::StringToId(msg.subject[2]);
-    time_t startts = Myth::StringToTime(msg.subject[3]);
-    MythProgramInfo prog(m_control->GetRecorded(chanid, startts));
-    if (!prog.IsNull())
+    if (it->type == RecordingChange::ChangeAdd)
+      ++adds;
+  }
+  if (adds > c_maximumRecordingAdds)
+  {
+    HandleRecordingReload();
+    return;
+  }
+
+  std::set<uint32_t> deletedIds;
+  std::set<std::pair<uint32_t, time_t> > deletedTimeslots;
+  for (RecordingChangeList::const_iterator ic = changes.begin(); ic != changes.end(); ++ic)
+  {
+    switch (ic->type)
     {
-      CLockObject lock(m_recordingsLock);
-      ProgramInfoMap::iterator it = m_recordings.find(prog.UID());
-      if (it == m_recordings.end())
+    case RecordingChange::ChangeAdd:
+    {
+      MythProgramInfo prog(ic->recordedId ? m_control->GetRecorded(ic->recordedId) : m_control->GetRecorded(ic->chanId, ic->startTs));
+      if (!prog.IsNull())
       {
-        if (g_bExtraDebug)
-          XBMC->Log(LOG_DEBUG, "%s: Add recording: %s", __FUNCTION__, prog.UID().c_str());
-        // Add recording
-        m_recordings.insert(std::pair<std::string, MythProgramInfo>(prog.UID().c_str(), prog));
-        ++m_recordingChangePinCount;
+        CLockObject lock(m_recordingsLock);
+        ProgramInfoMap::iterator it = m_recordings->find(prog.Key());
+        if (it == m_recordings->end())
+        {
+          if (g_bExtraDebug)
+            XBMC->Log(LOG_DEBUG, "%s: Add recording: %s", __FUNCTION__, prog.UID().c_str());
+          // Add recording
+          if (m_avinfoCache)
+            m_avinfoCache->Add(prog);
+          EditRecordings().insert(std::make_pair(prog.Key(), prog));
+          m_recordingsIndex.Add(prog);
+          ++m_recordingChangePinCount;
+          PrefetchRecordingEdl(prog);
+        }
       }
+      else if (ic->recordedId)
+        XBMC->Log(LOG_ERROR, "%s: Add recording failed for %u", __FUNCTION__, (unsigned)ic->recordedId);
+      else
+        XBMC->Log(LOG_ERROR, "%s: Add recording failed for %u %ld", __FUNCTION__, (unsigned)ic->chanId, (long)ic->startTs);
+      break;
     }
-    else
-      XBMC->Log(LOG_ERROR, "%s: Add recording failed for %u %ld", __FUNCTION__, (unsigned)chanid, (long)startts);
-  }
-  else if (cs == 3 && msg.subject[1] == "ADD")
-  {
-    uint32_t recordedid = Myth::StringToId(msg.subject[2]);
-    MythProgramInfo prog(m_control->GetRecorded(recordedid));
-    if (!prog.IsNull())
+    case RecordingChange::ChangeUpdate:
     {
+      MythProgramInfo prog(ic->program);
       CLockObject lock(m_recordingsLock);
-      ProgramInfoMap::iterator it = m_recordings.find(prog.UID());
-      if (it == m_recordings.end())
+      ProgramInfoMap::iterator it = m_recordings->find(prog.Key());
+      if (it == m_recordings->end())
+        break;
+      // Reuse artworks of the current entry when they refer to the same metadata
+      Myth::ProgramPtr current(it->second.GetPtr());
+      bool refreshArtwork = true;
+      if (current && current->inetref == ic->program->inetref && current->season == ic->program->season)
       {
-        if (g_bExtraDebug)
-          XBMC->Log(LOG_DEBUG, "%s: Add recording: %s", __FUNCTION__, prog.UID().c_str());
-        // Add recording
-        m_recordings.insert(std::pair<std::string, MythProgramInfo>(prog.UID().c_str(), prog));
-        ++m_recordingChangePinCount;
+        ic->program->artwork = current->artwork;
+        refreshArtwork = false;
       }
-    }
-    else
-      XBMC->Log(LOG_ERROR, "%s: Add recording failed for %u", __FUNCTION__, (unsigned)recordedid);
-  }
-  else if (cs == 2 && msg.subject[1] == "UPDATE" && msg.program)
-  {
-    CLockObject lock(m_recordingsLock);
-    MythProgramInfo prog(msg.program);
-    ProgramInfoMap::iterator it = m_recordings.find(prog.UID());
-    if (it != m_recordings.end())
-    {
-      if (g_bExtraDebug)
-        XBMC->Log(LOG_DEBUG, "%s: Update recording: %s", __FUNCTION__, prog.UID().c_str());
-      if (m_control->RefreshRecordedArtwork(*(msg.program)) && g_bExtraDebug)
+      lock.Unlock();
+      if (refreshArtwork && m_control->RefreshRecordedArtwork(*(ic->program)) && g_bExtraDebug)
         XBMC->Log(LOG_DEBUG, "%s: artwork found for %s", __FUNCTION__, prog.UID().c_str());
-      // Reset to recalculate flags
-      prog.ResetProps();
-      // Keep props
-      prog.CopyProps(it->second);
-      // Keep original air date
-      prog.GetPtr()->airdate = it->second.Airdate();
-      // Update recording
-      it->second = prog;
-      ++m_recordingChangePinCount;
-    }
-  }
-  else if (cs == 4 && msg.subject[1] == "DELETE")
-  {
-    // MythTV send two DELETE events. First requests deletion, second confirms deletion.
-    // On first we delete recording. On second program will not be found.
-    uint32_t chanid = Myth::StringToId(msg.subject[2]);
-    time_t startts = Myth::StringToTime(msg.subject[3]);
-    MythProgramInfo prog(m_control->GetRecorded(chanid, startts));
-    if (!prog.IsNull())
-    {
-      CLockObject lock(m_recordingsLock);
-      ProgramInfoMap::iterator it = m_recordings.find(prog.UID());
-      if (it != m_recordings.end())
+      lock.Lock();
+      ProgramInfoMap& recordings = EditRecordings();
+      it = recordings.find(prog.Key());
+      if (it != recordings.end())
       {
         if (g_bExtraDebug)
-          XBMC->Log(LOG_DEBUG, "%s: Delete recording: %s", __FUNCTION__, prog.UID().c_str());
-        // Remove recording
-        m_recordings.erase(it);
+          XBMC->Log(LOG_DEBUG, "%s: Update recording: %s", __FUNCTION__, prog.UID().c_str());
+        // Reset to recalculate flags
+        prog.ResetProps();
+        // Keep props
+        prog.CopyProps(it->second);
+        // Keep original air date
+        prog.GetPtr()->airdate = it->second.Airdate();
+        // Update recording
+        m_recordingsIndex.Remove(it->second);
+        m_recordingsIndex.Add(prog);
+        it->second = prog;
+        if (m_avinfoCache)
+          m_avinfoCache->Enqueue(it->second);
+        // Marks could have changed, i.e. when commercial flagging is done
+        m_edlCache->Invalidate(prog);
+        PrefetchRecordingEdl(prog);
         ++m_recordingChangePinCount;
       }
+      break;
+    }
+    case RecordingChange::ChangeDelete:
+      // MythTV send two DELETE events. First requests deletion, second confirms deletion.
+      // On first we delete recording. On second it will not be found.
+      if (ic->recordedId)
+        deletedIds.insert(ic->recordedId);
+      else
+        deletedTimeslots.insert(std::make_pair(ic->chanId, ic->startTs));
+      break;
     }
   }
-  else if (cs == 3 && msg.subject[1] == "DELETE")
+
+  // Deleted recordings are resolved locally in one pass
+  if (!deletedIds.empty() || !deletedTimeslots.empty())
   {
-    // MythTV send two DELETE events. First requests deletion, second confirms deletion.
-    // On first we delete recording. On second program will not be found.
-    uint32_t recordedid = Myth::StringToId(msg.subject[2]);
-    MythProgramInfo prog(m_control->GetRecorded(recordedid));
-    if (!prog.IsNull())
+    CLockObject lock(m_recordingsLock);
+    ProgramInfoMap& recordings = EditRecordings();
+    ProgramInfoMap::iterator it = recordings.begin();
+    while (it != recordings.end())
     {
-      CLockObject lock(m_recordingsLock);
-      ProgramInfoMap::iterator it = m_recordings.find(prog.UID());
-      if (it != m_recordings.end())
+      if (deletedIds.count(it->second.RecordedID()) ||
+              deletedTimeslots.count(std::make_pair(it->second.ChannelID(), it->second.RecordingStartTime())))
       {
         if (g_bExtraDebug)
-          XBMC->Log(LOG_DEBUG, "%s: Delete recording: %s", __FUNCTION__, prog.UID().c_str());
+          XBMC->Log(LOG_DEBUG, "%s: Delete recording: %s", __FUNCTION__, it->second.UID().c_str());
         // Remove recording
-        m_recordings.erase(it);
+        m_edlCache->Invalidate(it->second);
+        m_recordingsIndex.Remove(it->second);
+        it = recordings.erase(it);
         ++m_recordingChangePinCount;
       }
+      else
+        ++it;
     }
   }
 }
 
+void PVRClientMythTV::HandleAVInfoProbed(const MythProgramInfo& programInfo, float fps, float aspec)
+{
+  CLockObject lock(m_recordingsLock);
+  ProgramInfoMap::iterator it = m_recordings->find(programInfo.Key());
+  if (it != m_recordings->end())
+  {
+    it->second.SetPropsVideoFrameRate(fps);
+    it->second.SetPropsVideoAspec(aspec);
+  }
+}
+
 void PVRClientMythTV::RunHouseKeeping()
 {
   if (!m_control || !m_eventHandler)
@@ -505,21 +625,12 @@ void PVRClientMythTV::RunHouseKeeping()
   }
   if (m_recordingChangePinCount)
   {
-    CLockObject lock(m_recordingsLock);
-    m_recordingsAmountChange = true; // Need count recording amount
-    m_deletedRecAmountChange = true; // Need count of deleted amount
-    lock.Unlock();
     PVR->TriggerRecordingUpdate();
-    lock.Lock();
+    CLockObject lock(m_recordingsLock);
     m_recordingChangePinCount = 0;
   }
 }
 
-void PVRClientMythTV::HandleCleanedCache()
-{
-  PVR->TriggerRecordingUpdate();
-}
-
 PVR_ERROR PVRClientMythTV::GetEPGForChannel(ADDON_HANDLE handle, const PVR_CHANNEL &channel, time_t iStart, time_t iEnd)
 {
   if (!m_control)
@@ -530,6 +641,8 @@ PVR_ERROR PVRClientMythTV::GetEPGForChannel(ADDON_HANDLE handle, const PVR_CHANN
   if (!channel.bIsHidden)
   {
     Myth::ProgramMapPtr EPG = m_control->GetProgramGuide(channel.iUniqueId, iStart, iEnd);
+    // Keep the guide to resolve broadcasts and preview searches locally
+    m_guideIndex.Store(channel.iUniqueId, iStart, iEnd, *EPG);
     // Transfer EPG for the given channel
     for (Myth::ProgramMap::reverse_iterator it = EPG->rbegin(); it != EPG->rend(); ++it)
     {
@@ -583,13 +696,24 @@ PVR_ERROR PVRClientMythTV::GetEPGForChannel(ADDON_HANDLE handle, const PVR_CHANN
   return PVR_ERROR_NO_ERROR;
 }
 
+Myth::ProgramPtr PVRClientMythTV::FindGuideProgram(uint32_t chanid, time_t attime)
+{
+  Myth::ProgramPtr program = m_guideIndex.Find(chanid, attime);
+  if (program)
+    return program;
+  Myth::ProgramMapPtr epg = m_control->GetProgramGuide(chanid, attime, attime);
+  Myth::ProgramMap::reverse_iterator epgit = epg->rbegin(); // Get last found
+  if (epgit != epg->rend())
+    return epgit->second;
+  return Myth::ProgramPtr();
+}
+
 int PVRClientMythTV::GetNumChannels()
 {
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s", __FUNCTION__);
 
-  CLockObject lock(m_channelsLock);
-  return m_PVRChannels.size();
+  return GetChannelsData()->PVRChannels.size();
 }
 
 PVR_CHANNEL PVRClientMythTV::GetFirstChannel()
@@ -597,15 +721,15 @@ PVR_CHANNEL PVRClientMythTV::GetFirstChannel()
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s", __FUNCTION__);
 
-  CLockObject lock(m_channelsLock);
+  ChannelsDataPtr channels = GetChannelsData();
   PVR_CHANNEL tag;
   memset(&tag, 0, sizeof(PVR_CHANNEL));
 
-  PVRChannelList::const_iterator it = m_PVRChannels.begin();
-  if (it != m_PVRChannels.end())
+  PVRChannelList::const_iterator it = channels->PVRChannels.begin();
+  if (it != channels->PVRChannels.end())
   {
-    ChannelIdMap::const_iterator itm = m_channelsById.find(it->iUniqueId);
-    if (itm != m_channelsById.end() && !itm->second.IsNull())
+    ChannelIdMap::const_iterator itm = channels->channelsById.find(it->iUniqueId);
+    if (itm != channels->channelsById.end() && !itm->second.IsNull())
     {
       PVR_CHANNEL tag;
       memset(&tag, 0, sizeof(PVR_CHANNEL));
@@ -636,18 +760,20 @@ PVR_ERROR PVRClientMythTV::GetChannels(ADDON_HANDLE handle, bool bRadio)
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s: radio: %s", __FUNCTION__, (bRadio ? "true" : "false"));
 
-  CLockObject lock(m_channelsLock);
-
   // Load channels list
-  if (m_PVRChannels.empty())
+  ChannelsDataPtr channels = GetChannelsData();
+  if (channels->PVRChannels.empty())
+  {
     FillChannelsAndChannelGroups();
+    channels = GetChannelsData();
+  }
   // Transfer channels of the requested type (radio / tv)
-  for (PVRChannelList::const_iterator it = m_PVRChannels.begin(); it != m_PVRChannels.end(); ++it)
+  for (PVRChannelList::const_iterator it = channels->PVRChannels.begin(); it != channels->PVRChannels.end(); ++it)
   {
     if (it->bIsRadio == bRadio)
     {
-      ChannelIdMap::const_iterator itm = m_channelsById.find(it->iUniqueId);
-      if (itm != m_channelsById.end() && !itm->second.IsNull())
+      ChannelIdMap::const_iterator itm = channels->channelsById.find(it->iUniqueId);
+      if (itm != channels->channelsById.end() && !itm->second.IsNull())
       {
         PVR_CHANNEL tag;
         memset(&tag, 0, sizeof(PVR_CHANNEL));
@@ -685,8 +811,7 @@ int PVRClientMythTV::GetChannelGroupsAmount()
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s", __FUNCTION__);
 
-  CLockObject lock(m_channelsLock);
-  return m_PVRChannelGroups.size();
+  return GetChannelsData()->PVRChannelGroups.size();
 }
 
 PVR_ERROR PVRClientMythTV::GetChannelGroups(ADDON_HANDLE handle, bool bRadio)
@@ -694,10 +819,10 @@ PVR_ERROR PVRClientMythTV::GetChannelGroups(ADDON_HANDLE handle, bool bRadio)
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s: radio: %s", __FUNCTION__, (bRadio ? "true" : "false"));
 
-  CLockObject lock(m_channelsLock);
+  ChannelsDataPtr channels = GetChannelsData();
 
   // Transfer channel groups of the given type (radio / tv)
-  for (PVRChannelGroupMap::iterator itg = m_PVRChannelGroups.begin(); itg != m_PVRChannelGroups.end(); ++itg)
+  for (PVRChannelGroupMap::const_iterator itg = channels->PVRChannelGroups.begin(); itg != channels->PVRChannelGroups.end(); ++itg)
   {
     PVR_CHANNEL_GROUP tag;
     memset(&tag, 0, sizeof(PVR_CHANNEL_GROUP));
@@ -728,10 +853,10 @@ PVR_ERROR PVRClientMythTV::GetChannelGroupMembers(ADDON_HANDLE handle, const PVR
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s: group: %s", __FUNCTION__, group.strGroupName);
 
-  CLockObject lock(m_channelsLock);
+  ChannelsDataPtr channels = GetChannelsData();
 
-  PVRChannelGroupMap::iterator itg = m_PVRChannelGroups.find(group.strGroupName);
-  if (itg == m_PVRChannelGroups.end())
+  PVRChannelGroupMap::const_iterator itg = channels->PVRChannelGroups.find(group.strGroupName);
+  if (itg == channels->PVRChannelGroups.end())
   {
     XBMC->Log(LOG_ERROR,"%s: Channel group not found", __FUNCTION__);
     return PVR_ERROR_INVALID_PARAMETERS;
@@ -761,8 +886,14 @@ PVR_ERROR PVRClientMythTV::GetChannelGroupMembers(ADDON_HANDLE handle, const PVR
 
 bool PVRClientMythTV::IsPlaying() const
 {
-  P8PLATFORM::CLockObject lock(m_lock);
-  if (m_liveStream || m_dummyStream || m_recordingStream)
+  {
+    // A busy live session is tuning so it is playing
+    CTryLockObject lock(m_liveLock);
+    if (!lock.IsLocked() || m_liveStream || m_dummyStream)
+      return true;
+  }
+  CLockObject lock(m_recordedLock);
+  if (m_recordingStream)
     return true;
   return false;
 }
@@ -774,11 +905,9 @@ int PVRClientMythTV::FillChannelsAndChannelGroups()
   int count = 0;
   XBMC->Log(LOG_DEBUG, "%s", __FUNCTION__);
 
-  CLockObject lock(m_channelsLock);
-  m_PVRChannels.clear();
-  m_PVRChannelGroups.clear();
-  m_PVRChannelUidById.clear();
-  m_channelsById.clear();
+  // Build a new version while readers keep the published one
+  ChannelsData *channelsData = new ChannelsData();
+  ChannelsDataPtr channels(channelsData);
 
   // Create a channels map to merge channels with same channum and callsign within
   typedef std::pair<std::string, std::string> chanuid_t;
@@ -800,7 +929,7 @@ int PVRClientMythTV::FillChannelsAndChannelGroups()
       item.iUniqueId = chanid;
       item.bIsRadio = channel.IsRadio();
       // Store the new Myth channel in the map
-      m_channelsById.insert(std::make_pair(item.iUniqueId, channel));
+      channelsData->channelsById.insert(std::make_pair(item.iUniqueId, channel));
 
       // Looking for PVR channel with same channum and callsign
       chanuid_t channelIdentifier = std::make_pair(channel.Number(), channel.Callsign());
@@ -810,42 +939,52 @@ int PVRClientMythTV::FillChannelsAndChannelGroups()
         if (g_bExtraDebug)
           XBMC->Log(LOG_DEBUG, "%s: skipping channel: %d", __FUNCTION__, chanid);
         // Link channel to PVR item
-        m_PVRChannelUidById.insert(std::make_pair(chanid, itm->second.iUniqueId));
+        channelsData->PVRChannelUidById.insert(std::make_pair(chanid, itm->second.iUniqueId));
         // Add found PVR item to the grouping set
         channelIDs.insert(itm->second);
       }
       else
       {
         ++count;
-        m_PVRChannels.push_back(item);
+        channelsData->PVRChannels.push_back(item);
         channelIdentifiers.insert(std::make_pair(channelIdentifier, item));
         // Link channel to PVR item
-        m_PVRChannelUidById.insert(std::make_pair(chanid, item.iUniqueId));
+        channelsData->PVRChannelUidById.insert(std::make_pair(chanid, item.iUniqueId));
         // Add the new PVR item to the grouping set
         channelIDs.insert(item);
       }
     }
-    m_PVRChannelGroups.insert(std::make_pair((*its)->sourceName, PVRChannelList(channelIDs.begin(), channelIDs.end())));
+    channelsData->PVRChannelGroups.insert(std::make_pair((*its)->sourceName, PVRChannelList(channelIDs.begin(), channelIDs.end())));
   }
 
-  XBMC->Log(LOG_DEBUG, "%s: Loaded %d channel(s) %d group(s)", __FUNCTION__, count, (unsigned)m_PVRChannelGroups.size());
+  CLockObject lock(m_channelsLock);
+  m_channels = channels;
+  lock.Unlock();
+
+  XBMC->Log(LOG_DEBUG, "%s: Loaded %d channel(s) %d group(s)", __FUNCTION__, count, (unsigned)channelsData->PVRChannelGroups.size());
   return count;
 }
 
-MythChannel PVRClientMythTV::FindChannel(uint32_t channelId) const
+PVRClientMythTV::ChannelsDataPtr PVRClientMythTV::GetChannelsData() const
 {
   CLockObject lock(m_channelsLock);
-  ChannelIdMap::const_iterator it = m_channelsById.find(channelId);
-  if (it != m_channelsById.end())
+  return m_channels;
+}
+
+MythChannel PVRClientMythTV::FindChannel(uint32_t channelId) const
+{
+  ChannelsDataPtr channels = GetChannelsData();
+  ChannelIdMap::const_iterator it = channels->channelsById.find(channelId);
+  if (it != channels->channelsById.end())
     return it->second;
   return MythChannel();
 }
 
 int PVRClientMythTV::FindPVRChannelUid(uint32_t channelId) const
 {
-  CLockObject lock(m_channelsLock);
-  PVRChannelMap::const_iterator it = m_PVRChannelUidById.find(channelId);
-  if (it != m_PVRChannelUidById.end())
+  ChannelsDataPtr channels = GetChannelsData();
+  PVRChannelMap::const_iterator it = channels->PVRChannelUidById.find(channelId);
+  if (it != channels->PVRChannelUidById.end())
     return it->second;
   return PVR_CHANNEL_INVALID_UID;
 }
@@ -855,20 +994,8 @@ int PVRClientMythTV::GetRecordingsAmount()
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s", __FUNCTION__);
 
-  if (m_recordingsAmountChange)
-  {
-    int res = 0;
-    CLockObject lock(m_recordingsLock);
-    for (ProgramInfoMap::iterator it = m_recordings.begin(); it != m_recordings.end(); ++it)
-    {
-      if (!it->second.IsNull() && it->second.IsVisible() && (g_bLiveTVRecordings || !it->second.IsLiveTV()))
-        res++;
-    }
-    m_recordingsAmount = res;
-    m_recordingsAmountChange = false;
-    XBMC->Log(LOG_DEBUG, "%s: count %d", __FUNCTION__, res);
-  }
-  return m_recordingsAmount;
+  CLockObject lock(m_recordingsLock);
+  return m_recordingsIndex.VisibleCount(g_bLiveTVRecordings);
 }
 
 PVR_ERROR PVRClientMythTV::GetRecordings(ADDON_HANDLE handle)
@@ -876,116 +1003,28 @@ PVR_ERROR PVRClientMythTV::GetRecordings(ADDON_HANDLE handle)
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s", __FUNCTION__);
 
+  // Collect tags of the published version, then transfer them unlocked. Stale
+  // tags are rebuilt on the version to change, so readers keep the ones they hold.
   CLockObject lock(m_recordingsLock);
-
-  // Setup series
-  if (g_iGroupRecordings == GROUP_RECORDINGS_ONLY_FOR_SERIES)
+  std::vector<RecordingTagPtr> tags;
+  tags.reserve(m_recordings->size());
+  if (!CollectRecordingTags(*m_recordings, false, false, tags))
   {
-    typedef std::map<std::pair<std::string, std::string>, ProgramInfoMap::iterator::pointer> TitlesMap;
-    TitlesMap titles;
-    for (ProgramInfoMap::iterator it = m_recordings.begin(); it != m_recordings.end(); ++it)
-    {
-      if (!it->second.IsNull() && it->second.IsVisible() && (g_bLiveTVRecordings || !it->second.IsLiveTV()))
-      {
-        std::pair<std::string, std::string> title = std::make_pair(it->second.RecordingGroup(), it->second.Title());
-        TitlesMap::iterator found = titles.find(title);
-        if (found != titles.end())
-        {
-          if (found->second)
-          {
-            found->second->second.SetPropsSerie(true);
-            found->second = NULL;
-          }
-          it->second.SetPropsSerie(true);
-        }
-        else
-          titles.insert(std::make_pair(title, &(*it)));
-      }
-    }
+    tags.clear();
+    CollectRecordingTags(EditRecordings(), false, true, tags);
   }
+  lock.Unlock();
+
   time_t now = time(NULL);
   // Transfer to PVR
-  for (ProgramInfoMap::iterator it = m_recordings.begin(); it != m_recordings.end(); ++it)
+  for (std::vector<RecordingTagPtr>::const_iterator it = tags.begin(); it != tags.end(); ++it)
   {
-    if (!it->second.IsNull() && it->second.IsVisible() && (g_bLiveTVRecordings || !it->second.IsLiveTV()))
-    {
-      PVR_RECORDING tag;
-      memset(&tag, 0, sizeof(PVR_RECORDING));
-      tag.bIsDeleted = false;
-
-      tag.recordingTime = GetRecordingTime(it->second.Airdate(), it->second.RecordingStartTime());
-      tag.iDuration = it->second.Duration();
-      tag.iPlayCount = it->second.IsWatched() ? 1 : 0;
-      tag.iLastPlayedPosition = it->second.HasBookmark() ? 1 : 0;
-
-      std::string id = it->second.UID();
-
-      PVR_STRCPY(tag.strRecordingId, id.c_str());
-      PVR_STRCPY(tag.strTitle, it->second.Title().c_str());
-      PVR_STRCPY(tag.strEpisodeName, it->second.Subtitle().c_str());
-      tag.iSeriesNumber = it->second.Season();
-      tag.iEpisodeNumber = it->second.Episode();
-      time_t airTime(it->second.Airdate());
-      if (difftime(airTime, 0) > 0)
-      {
-        struct tm airTimeDate;
-        localtime_r(&airTime, &airTimeDate);
-        tag.iYear = airTimeDate.tm_year + 1900;
-      }
-      PVR_STRCPY(tag.strPlot, it->second.Description().c_str());
-      PVR_STRCPY(tag.strChannelName, it->second.ChannelName().c_str());
-      tag.iChannelUid = FindPVRChannelUid(it->second.ChannelID());
-      tag.channelType = PVR_RECORDING_CHANNEL_TYPE_TV;
-
-      int genre = m_categories.Category(it->second.Category());
-      tag.iGenreSubType = genre&0x0F;
-      tag.iGenreType = genre&0xF0;
-
-      // Add recording title to directory to group everything according to its name just like MythTV does
-      std::string strDirectory(it->second.RecordingGroup());
-      if (g_iGroupRecordings == GROUP_RECORDINGS_ALWAYS || (g_iGroupRecordings == GROUP_RECORDINGS_ONLY_FOR_SERIES && it->second.GetPropsSerie()))
-        strDirectory.append("/").append(it->second.Title());
-      PVR_STRCPY(tag.strDirectory, strDirectory.c_str());
-
-      // Images
-      std::string strIconPath;
-      std::string strThumbnailPath;
-      std::string strFanartPath;
-      if (m_fileOps)
-      {
-        strThumbnailPath = m_fileOps->GetPreviewIconPath(it->second);
-
-        if (it->second.HasCoverart())
-          strIconPath = m_fileOps->GetArtworkPath(it->second, FileOps::FileTypeCoverart);
-        else if (it->second.IsLiveTV())
-        {
-          MythChannel channel = FindRecordingChannel(it->second);
-          if (!channel.IsNull())
-            strIconPath = m_fileOps->GetChannelIconPath(channel);
-        }
-        else
-          strIconPath = strThumbnailPath;
-
-        if (it->second.HasFanart())
-          strFanartPath = m_fileOps->GetArtworkPath(it->second, FileOps::FileTypeFanart);
-      }
-      PVR_STRCPY(tag.strIconPath, strIconPath.c_str());
-      PVR_STRCPY(tag.strThumbnailPath, strThumbnailPath.c_str());
-      PVR_STRCPY(tag.strFanartPath, strFanartPath.c_str());
-
-      // EPG Entry (Enables "Play recording" option and icon)
-      if (!it->second.IsLiveTV() && difftime(now, it->second.EndTime()) < INTERVAL_DAY) // Up to 1 day in the past
-        tag.iEpgEventId = MythEPGInfo::MakeBroadcastID(FindPVRChannelUid(it->second.ChannelID()), it->second.StartTime());
-
-      // Unimplemented
-      tag.iLifetime = 0;
-      tag.iPriority = 0;
-      PVR_STRCPY(tag.strPlotOutline, "");
-      PVR_STRCPY(tag.strStreamURL, "");
-
-      PVR->TransferRecordingEntry(handle, &tag);
-    }
+    PVR_RECORDING tag;
+    FillRecordingTag(*static_cast<const RecordingTag*>(it->get()), now, tag);
+    PVR->TransferRecordingEntry(handle, &tag);
   }
+  // Served artworks are the recently used ones of the cache
+  TouchRecordingArtworks(tags);
 
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s: Done", __FUNCTION__);
@@ -998,20 +1037,8 @@ int PVRClientMythTV::GetDeletedRecordingsAmount()
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s", __FUNCTION__);
 
-  if (m_deletedRecAmountChange)
-  {
-    int res = 0;
-    CLockObject lock(m_recordingsLock);
-    for (ProgramInfoMap::iterator it = m_recordings.begin(); it != m_recordings.end(); ++it)
-    {
-      if (!it->second.IsNull() && it->second.IsDeleted() && (g_bLiveTVRecordings || !it->second.IsLiveTV()))
-        res++;
-    }
-    m_deletedRecAmount = res;
-    m_deletedRecAmountChange = false;
-    XBMC->Log(LOG_DEBUG, "%s: count %d", __FUNCTION__, res);
-  }
-  return m_deletedRecAmount;
+  CLockObject lock(m_recordingsLock);
+  return m_recordingsIndex.DeletedCount(g_bLiveTVRecordings);
 }
 
 PVR_ERROR PVRClientMythTV::GetDeletedRecordings(ADDON_HANDLE handle)
@@ -1019,94 +1046,226 @@ PVR_ERROR PVRClientMythTV::GetDeletedRecordings(ADDON_HANDLE handle)
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s", __FUNCTION__);
 
+  // Collect tags of the published version, then transfer them unlocked
   CLockObject lock(m_recordingsLock);
+  std::vector<RecordingTagPtr> tags;
+  if (!CollectRecordingTags(*m_recordings, true, false, tags))
+  {
+    tags.clear();
+    CollectRecordingTags(EditRecordings(), true, true, tags);
+  }
+  lock.Unlock();
 
+  time_t now = time(NULL);
   // Transfer to PVR
-  for (ProgramInfoMap::iterator it = m_recordings.begin(); it != m_recordings.end(); ++it)
+  for (std::vector<RecordingTagPtr>::const_iterator it = tags.begin(); it != tags.end(); ++it)
   {
-    if (!it->second.IsNull() && it->second.IsDeleted() && (g_bLiveTVRecordings || !it->second.IsLiveTV()))
-    {
-      PVR_RECORDING tag;
-      memset(&tag, 0, sizeof(PVR_RECORDING));
-      tag.bIsDeleted = true;
+    PVR_RECORDING tag;
+    FillRecordingTag(*static_cast<const RecordingTag*>(it->get()), now, tag);
+    PVR->TransferRecordingEntry(handle, &tag);
+  }
+  // Served artworks are the recently used ones of the cache
+  TouchRecordingArtworks(tags);
 
-      tag.recordingTime = GetRecordingTime(it->second.Airdate(), it->second.RecordingStartTime());
-      tag.iDuration = it->second.Duration();
-      tag.iPlayCount = it->second.IsWatched() ? 1 : 0;
-      tag.iLastPlayedPosition = it->second.HasBookmark() ? 1 : 0;
+  if (g_bExtraDebug)
+    XBMC->Log(LOG_DEBUG, "%s: Done", __FUNCTION__);
 
-      std::string id = it->second.UID();
+  return PVR_ERROR_NO_ERROR;
+}
 
-      PVR_STRCPY(tag.strRecordingId, id.c_str());
-      PVR_STRCPY(tag.strTitle, it->second.Title().c_str());
-      PVR_STRCPY(tag.strEpisodeName, it->second.Subtitle().c_str());
-      tag.iSeriesNumber = it->second.Season();
-      tag.iEpisodeNumber = it->second.Episode();
-      time_t airTime(it->second.Airdate());
-      if (difftime(airTime, 0) > 0)
-      {
-        struct tm airTimeDate;
-        localtime_r(&airTime, &airTimeDate);
-        tag.iYear = airTimeDate.tm_year + 1900;
-      }
-      PVR_STRCPY(tag.strPlot, it->second.Description().c_str());
-      PVR_STRCPY(tag.strChannelName, it->second.ChannelName().c_str());
-      tag.iChannelUid = FindPVRChannelUid(it->second.ChannelID());
-      tag.channelType = PVR_RECORDING_CHANNEL_TYPE_TV;
-
-      int genre = m_categories.Category(it->second.Category());
-      tag.iGenreSubType = genre&0x0F;
-      tag.iGenreType = genre&0xF0;
-
-      // Default to root of deleted view
-      PVR_STRCPY(tag.strDirectory, "");
-
-      // Images
-      std::string strIconPath;
-      std::string strThumbnailPath;
-      std::string strFanartPath;
-      if (m_fileOps)
-      {
-        strThumbnailPath = m_fileOps->GetPreviewIconPath(it->second);
+bool PVRClientMythTV::CollectRecordingTags(ProgramInfoMap& recordings, bool deleted, bool build, std::vector<RecordingTagPtr>& tags)
+{
+  for (ProgramInfoMap::iterator it = recordings.begin(); it != recordings.end(); ++it)
+  {
+    if (it->second.IsNull() || (g_bLiveTVRecordings == false && it->second.IsLiveTV()))
+      continue;
+    if (deleted ? !it->second.IsDeleted() : !it->second.IsVisible())
+      continue;
+    bool serie = (!deleted && g_iGroupRecordings == GROUP_RECORDINGS_ONLY_FOR_SERIES &&
+            m_recordingsIndex.IsSerie(it->second, g_bLiveTVRecordings));
+    if (!IsRecordingTagValid(static_cast<const RecordingTag*>(it->second.GetCache().get()), deleted, serie))
+    {
+      // Entries of a shared version must not be changed
+      if (!build)
+        return false;
+      BuildRecordingTag(it->second, deleted, serie);
+    }
+    tags.push_back(it->second.GetCache());
+  }
+  return true;
+}
 
-        if (it->second.HasCoverart())
-          strIconPath = m_fileOps->GetArtworkPath(it->second, FileOps::FileTypeCoverart);
-        else if (it->second.IsLiveTV())
-        {
-          MythChannel channel = FindRecordingChannel(it->second);
-          if (!channel.IsNull())
-            strIconPath = m_fileOps->GetChannelIconPath(channel);
-        }
-        else
-          strIconPath = strThumbnailPath;
+bool PVRClientMythTV::IsRecordingTagValid(const RecordingTag *cached, bool deleted, bool serie) const
+{
+  return (cached && cached->generation == m_recordingTagGeneration && !cached->artworkEvicted && cached->deleted == deleted &&
+          cached->serie == serie && cached->groupRecordings == g_iGroupRecordings && cached->useAirdate == g_bUseAirdate);
+}
 
-        if (it->second.HasFanart())
-          strFanartPath = m_fileOps->GetArtworkPath(it->second, FileOps::FileTypeFanart);
-      }
-      PVR_STRCPY(tag.strIconPath, strIconPath.c_str());
-      PVR_STRCPY(tag.strThumbnailPath, strThumbnailPath.c_str());
-      PVR_STRCPY(tag.strFanartPath, strFanartPath.c_str());
+void PVRClientMythTV::BuildRecordingTag(const MythProgramInfo& recording, bool deleted, bool serie)
+{
+  RecordingTag *cached = new RecordingTag();
+  recording.SetCache(cached);
+  cached->generation = m_recordingTagGeneration;
+  cached->artworkEvicted = false;
+  cached->deleted = deleted;
+  cached->serie = serie;
+  cached->groupRecordings = g_iGroupRecordings;
+  cached->useAirdate = g_bUseAirdate;
 
-      // Unimplemented
-      tag.iLifetime = 0;
-      tag.iPriority = 0;
-      PVR_STRCPY(tag.strPlotOutline, "");
-      PVR_STRCPY(tag.strStreamURL, "");
+  cached->recordingTime = GetRecordingTime(recording.Airdate(), recording.RecordingStartTime());
+  cached->duration = recording.Duration();
+  cached->playCount = recording.IsWatched() ? 1 : 0;
+  cached->lastPlayedPosition = recording.HasBookmark() ? 1 : 0;
+
+  cached->recordingId = recording.UID();
+  cached->title = recording.Title();
+  cached->episodeName = recording.Subtitle();
+  cached->seriesNumber = recording.Season();
+  cached->episodeNumber = recording.Episode();
+  cached->year = 0;
+  time_t airTime(recording.Airdate());
+  if (difftime(airTime, 0) > 0)
+  {
+    struct tm airTimeDate;
+    localtime_r(&airTime, &airTimeDate);
+    cached->year = airTimeDate.tm_year + 1900;
+  }
+  cached->plot = recording.Description();
+  cached->channelName = recording.ChannelName();
+
+  int genre = m_categories.Category(recording.Category());
+  cached->genreSubType = genre&0x0F;
+  cached->genreType = genre&0xF0;
 
-      /* TODO: PVR API 5.0.0: Implement this */
-      tag.iChannelUid = PVR_CHANNEL_INVALID_UID;
+  if (deleted)
+  {
+    // Default to root of deleted view
+    cached->directory.clear();
+    /* TODO: PVR API 5.0.0: Implement this */
+    cached->channelUid = PVR_CHANNEL_INVALID_UID;
+    /* TODO: PVR API 5.1.0: Implement this */
+    cached->channelType = PVR_RECORDING_CHANNEL_TYPE_UNKNOWN;
+  }
+  else
+  {
+    // Add recording title to directory to group everything according to its name just like MythTV does
+    cached->directory = recording.RecordingGroup();
+    if (g_iGroupRecordings == GROUP_RECORDINGS_ALWAYS || serie)
+      cached->directory.append("/").append(recording.Title());
+    cached->channelUid = FindPVRChannelUid(recording.ChannelID());
+    cached->channelType = PVR_RECORDING_CHANNEL_TYPE_TV;
+  }
 
-      /* TODO: PVR API 5.1.0: Implement this */
-      tag.channelType = PVR_RECORDING_CHANNEL_TYPE_UNKNOWN;
+  // Images
+  if (m_fileOps)
+  {
+    cached->thumbnailPath = m_fileOps->GetPreviewIconPath(recording);
 
-      PVR->TransferRecordingEntry(handle, &tag);
+    if (recording.HasCoverart())
+      cached->iconPath = m_fileOps->GetArtworkPath(recording, FileOps::FileTypeCoverart);
+    else if (recording.IsLiveTV())
+    {
+      MythChannel channel = FindRecordingChannel(recording);
+      if (!channel.IsNull())
+        cached->iconPath = m_fileOps->GetChannelIconPath(channel);
     }
+    else
+      cached->iconPath = cached->thumbnailPath;
+
+    if (recording.HasFanart())
+      cached->fanartPath = m_fileOps->GetArtworkPath(recording, FileOps::FileTypeFanart);
   }
 
-  if (g_bExtraDebug)
-    XBMC->Log(LOG_DEBUG, "%s: Done", __FUNCTION__);
+  // EPG Entry (Enables "Play recording" option and icon)
+  cached->epgEventId = 0;
+  cached->epgEndTime = recording.EndTime();
+  if (!deleted && !recording.IsLiveTV())
+    cached->epgEventId = MythEPGInfo::MakeBroadcastID(cached->channelUid, recording.StartTime());
+}
 
-  return PVR_ERROR_NO_ERROR;
+void PVRClientMythTV::TouchRecordingArtworks(const std::vector<RecordingTagPtr>& tags)
+{
+  if (!m_fileOps)
+    return;
+  std::vector<std::string> paths;
+  paths.reserve(tags.size() * 3);
+  for (std::vector<RecordingTagPtr>::const_iterator it = tags.begin(); it != tags.end(); ++it)
+  {
+    const RecordingTag *cached = static_cast<const RecordingTag*>(it->get());
+    if (!cached->thumbnailPath.empty())
+      paths.push_back(cached->thumbnailPath);
+    if (!cached->iconPath.empty() && cached->iconPath != cached->thumbnailPath)
+      paths.push_back(cached->iconPath);
+    if (!cached->fanartPath.empty())
+      paths.push_back(cached->fanartPath);
+  }
+  std::set<std::string> evicted;
+  m_fileOps->TouchFiles(paths, evicted);
+  if (evicted.empty())
+    return;
+  // Only the tags serving an evicted file are rebuilt, so that the file is queued again on next listing
+  CLockObject lock(m_recordingsLock);
+  for (std::vector<RecordingTagPtr>::const_iterator it = tags.begin(); it != tags.end(); ++it)
+  {
+    const RecordingTag *cached = static_cast<const RecordingTag*>(it->get());
+    if (evicted.find(cached->thumbnailPath) != evicted.end() || evicted.find(cached->iconPath) != evicted.end() ||
+            evicted.find(cached->fanartPath) != evicted.end())
+      cached->artworkEvicted = true;
+  }
+}
+
+void PVRClientMythTV::FillRecordingTag(const RecordingTag& cached, time_t now, PVR_RECORDING& tag)
+{
+  memset(&tag, 0, sizeof(PVR_RECORDING));
+  tag.bIsDeleted = cached.deleted;
+
+  tag.recordingTime = cached.recordingTime;
+  tag.iDuration = cached.duration;
+  tag.iPlayCount = cached.playCount;
+  tag.iLastPlayedPosition = cached.lastPlayedPosition;
+
+  PVR_STRCPY(tag.strRecordingId, cached.recordingId.c_str());
+  PVR_STRCPY(tag.strTitle, cached.title.c_str());
+  PVR_STRCPY(tag.strEpisodeName, cached.episodeName.c_str());
+  tag.iSeriesNumber = cached.seriesNumber;
+  tag.iEpisodeNumber = cached.episodeNumber;
+  tag.iYear = cached.year;
+  PVR_STRCPY(tag.strPlot, cached.plot.c_str());
+  PVR_STRCPY(tag.strChannelName, cached.channelName.c_str());
+  tag.iChannelUid = cached.channelUid;
+  tag.channelType = cached.channelType;
+  tag.iGenreSubType = cached.genreSubType;
+  tag.iGenreType = cached.genreType;
+  PVR_STRCPY(tag.strDirectory, cached.directory.c_str());
+  PVR_STRCPY(tag.strIconPath, cached.iconPath.c_str());
+  PVR_STRCPY(tag.strThumbnailPath, cached.thumbnailPath.c_str());
+  PVR_STRCPY(tag.strFanartPath, cached.fanartPath.c_str());
+
+  // EPG Entry: Up to 1 day in the past
+  if (cached.epgEventId && difftime(now, cached.epgEndTime) < INTERVAL_DAY)
+    tag.iEpgEventId = cached.epgEventId;
+
+  // Unimplemented
+  tag.iLifetime = 0;
+  tag.iPriority = 0;
+  PVR_STRCPY(tag.strPlotOutline, "");
+  PVR_STRCPY(tag.strStreamURL, "");
+}
+
+ProgramInfoMap& PVRClientMythTV::EditRecordings()
+{
+  // Readers hold the published version: publish a copy
+  if (m_recordings.use_count() > 1)
+    m_recordings.reset(new ProgramInfoMap(*m_recordings));
+  return *m_recordings;
+}
+
+ProgramInfoMap::iterator PVRClientMythTV::FindRecording(const char *uid)
+{
+  MythProgramKey key;
+  if (!MythProgramKey::FromUID(uid, key))
+    return m_recordings->end();
+  return m_recordings->find(key);
 }
 
 void PVRClientMythTV::ForceUpdateRecording(ProgramInfoMap::iterator it)
@@ -1124,6 +1283,8 @@ void PVRClientMythTV::ForceUpdateRecording(ProgramInfoMap::iterator it)
       // Copy props
       prog.CopyProps(it->second);
       // Update recording
+      m_recordingsIndex.Remove(it->second);
+      m_recordingsIndex.Add(prog);
       it->second = prog;
       ++m_recordingChangePinCount;
 
@@ -1144,46 +1305,111 @@ int PVRClientMythTV::FillRecordings()
   if (!m_eventHandler->IsConnected())
     return count;
 
-  // Load recordings map
-  m_recordings.clear();
-  m_recordingsAmount = 0;
-  m_deletedRecAmount = 0;
   Myth::ProgramListPtr programs = m_control->GetRecordedList();
-  for (Myth::ProgramList::iterator it = programs->begin(); it != programs->end(); ++it)
+  // Merge out of the lock into a new version, which is published only if no
+  // other change was published meanwhile. Else merge again.
+  CLockObject lock(m_recordingsLock);
+  ProgramInfoMapPtr recordings;
+  int added, updated, kept;
+  for (;;)
   {
-    MythProgramInfo prog = MythProgramInfo(*it);
-    m_recordings.insert(std::make_pair(prog.UID(), prog));
-    ++count;
+    ProgramInfoMapPtr base(m_recordings);
+    bool probeAdded = m_recordingsMerged;
+    lock.Unlock();
+    recordings = MergeRecordedList(*base, *programs, probeAdded, added, updated, kept);
+    lock.Lock();
+    if (m_recordings.get() == base.get())
+      break;
+  }
+  int removed = (int)m_recordings->size() - kept - updated;
+  // Publish the new version. Readers keep the previous one.
+  m_recordings = recordings;
+  m_recordingsMerged = true;
+  // Fill AV props from cache or queue them for probing, and drop the entries of gone recordings
+  if (m_avinfoCache)
+  {
+    std::set<AVInfoCache::CacheKey> keys;
+    for (ProgramInfoMap::iterator it = m_recordings->begin(); it != m_recordings->end(); ++it)
+    {
+      m_avinfoCache->Enqueue(it->second);
+      keys.insert(AVInfoCache::MakeKey(it->second));
+    }
+    m_avinfoCache->Prune(keys);
   }
+  count = added + updated + removed;
   if (count > 0)
-    m_recordingsAmountChange = m_deletedRecAmountChange = true; // Need count amounts
-  XBMC->Log(LOG_DEBUG, "%s: count %d", __FUNCTION__, count);
+    m_recordingsIndex.Rebuild(*m_recordings);
+  XBMC->Log(LOG_DEBUG, "%s: count %d (added %d, updated %d, removed %d)", __FUNCTION__,
+          (int)m_recordings->size(), added, updated, removed);
   return count;
 }
 
+PVRClientMythTV::ProgramInfoMapPtr PVRClientMythTV::MergeRecordedList(const ProgramInfoMap& base, Myth::ProgramList& programs, bool probeAdded,
+        int& added, int& updated, int& kept)
+{
+  // Entries holding the same revision are kept as is, with their props and
+  // flags. Only new, changed or gone entries are counted as changes.
+  ProgramInfoMapPtr recordings(new ProgramInfoMap());
+  added = updated = kept = 0;
+  recordings->reserve(programs.size());
+  for (Myth::ProgramList::iterator it = programs.begin(); it != programs.end(); ++it)
+  {
+    MythProgramInfo prog = MythProgramInfo(*it);
+    MythProgramKey key = prog.Key();
+    ProgramInfoMap::const_iterator old = base.find(key);
+    if (old == base.end())
+    {
+      // Recordings found at startup are not probed in background
+      if (m_avinfoCache && probeAdded)
+        m_avinfoCache->Add(prog);
+      recordings->insert(std::make_pair(key, prog));
+      ++added;
+    }
+    else if (old->second.IsSameRevision(prog))
+    {
+      recordings->insert(*old);
+      ++kept;
+    }
+    else
+    {
+      // Keep props
+      prog.CopyProps(old->second);
+      recordings->insert(std::make_pair(key, prog));
+      ++updated;
+    }
+  }
+  return recordings;
+}
+
 PVR_ERROR PVRClientMythTV::DeleteRecording(const PVR_RECORDING &recording)
 {
   if (!m_control)
     return PVR_ERROR_SERVER_ERROR;
   XBMC->Log(LOG_DEBUG, "%s", __FUNCTION__);
 
-  CLockObject lock(m_recordingsLock);
-
-  ProgramInfoMap::iterator it = m_recordings.find(recording.strRecordingId);
-  if (it != m_recordings.end())
+  // Don't hold the recordings while waiting for the live session
+  MythProgramInfo prog;
+  {
+    CLockObject lock(m_recordingsLock);
+    ProgramInfoMap::iterator it = FindRecording(recording.strRecordingId);
+    if (it != m_recordings->end())
+      prog = it->second;
+  }
+  if (!prog.IsNull())
   {
     // Deleting Live recording is prohibited. Otherwise continue
-    if (this->IsMyLiveRecording(it->second))
+    if (this->IsMyLiveRecording(prog))
     {
-      if (it->second.IsLiveTV())
+      if (prog.IsLiveTV())
         return PVR_ERROR_RECORDING_RUNNING;
       // it is kept then ignore it now.
+      CLockObject lock(m_liveLock);
       if (m_liveStream && m_liveStream->KeepLiveRecording(false))
         return PVR_ERROR_NO_ERROR;
       else
         return PVR_ERROR_FAILED;
     }
-    bool ret = m_control->DeleteRecording(*(it->second.GetPtr()));
+    bool ret = m_control->DeleteRecording(*(prog.GetPtr()));
     if (ret)
     {
       XBMC->Log(LOG_DEBUG, "%s: Deleted recording %s", __FUNCTION__, recording.strRecordingId);
@@ -1207,23 +1433,29 @@ PVR_ERROR PVRClientMythTV::DeleteAndForgetRecording(const PVR_RECORDING &recordi
     return PVR_ERROR_SERVER_ERROR;
   XBMC->Log(LOG_DEBUG, "%s", __FUNCTION__);
 
-  CLockObject lock(m_recordingsLock);
-
-  ProgramInfoMap::iterator it = m_recordings.find(recording.strRecordingId);
-  if (it != m_recordings.end())
+  // Don't hold the recordings while waiting for the live session
+  MythProgramInfo prog;
+  {
+    CLockObject lock(m_recordingsLock);
+    ProgramInfoMap::iterator it = FindRecording(recording.strRecordingId);
+    if (it != m_recordings->end())
+      prog = it->second;
+  }
+  if (!prog.IsNull())
   {
     // Deleting Live recording is prohibited. Otherwise continue
-    if (this->IsMyLiveRecording(it->second))
+    if (this->IsMyLiveRecording(prog))
     {
-      if (it->second.IsLiveTV())
+      if (prog.IsLiveTV())
         return PVR_ERROR_RECORDING_RUNNING;
       // it is kept then ignore it now.
+      CLockObject lock(m_liveLock);
       if (m_liveStream && m_liveStream->KeepLiveRecording(false))
         return PVR_ERROR_NO_ERROR;
       else
         return PVR_ERROR_FAILED;
     }
-    bool ret = m_control->DeleteRecording(*(it->second.GetPtr()), false, true);
+    bool ret = m_control->DeleteRecording(*(prog.GetPtr()), false, true);
     if (ret)
     {
       XBMC->Log(LOG_DEBUG, "%s: Deleted and forget recording %s", __FUNCTION__, recording.strRecordingId);
@@ -1248,8 +1480,10 @@ PVR_ERROR PVRClientMythTV::SetRecordingPlayCount(const PVR_RECORDING &recording,
   XBMC->Log(LOG_DEBUG, "%s", __FUNCTION__);
 
   CLockObject lock(m_recordingsLock);
-  ProgramInfoMap::iterator it = m_recordings.find(recording.strRecordingId);
-  if (it != m_recordings.end())
+  // The entry could be updated
+  EditRecordings();
+  ProgramInfoMap::iterator it = FindRecording(recording.strRecordingId);
+  if (it != m_recordings->end())
   {
     if (m_control->UpdateRecordedWatchedStatus(*(it->second.GetPtr()), (count > 0 ? true : false)))
     {
@@ -1271,9 +1505,9 @@ PVR_ERROR PVRClientMythTV::SetRecordingPlayCount(const PVR_RECORDING &recording,
               "", XBMC->GetLocalizedString(117)))
       {
         if (m_control->DeleteRecording(*(it->second.GetPtr())))
-          XBMC->Log(LOG_DEBUG, "%s: Deleted recording %s", __FUNCTION__, it->first.c_str());
+          XBMC->Log(LOG_DEBUG, "%s: Deleted recording %s", __FUNCTION__, it->second.UID().c_str());
         else
-          XBMC->Log(LOG_ERROR, "%s: Failed to delete recording %s", __FUNCTION__, it->first.c_str());
+          XBMC->Log(LOG_ERROR, "%s: Failed to delete recording %s", __FUNCTION__, it->second.UID().c_str());
       }
     }
 
@@ -1292,8 +1526,8 @@ PVR_ERROR PVRClientMythTV::SetRecordingLastPlayedPosition(const PVR_RECORDING &r
     XBMC->Log(LOG_DEBUG, "%s: Setting Bookmark for: %s to %d", __FUNCTION__, recording.strTitle, lastplayedposition);
 
   CLockObject lock(m_recordingsLock);
-  ProgramInfoMap::iterator it = m_recordings.find(recording.strRecordingId);
-  if (it != m_recordings.end())
+  ProgramInfoMap::iterator it = FindRecording(recording.strRecordingId);
+  if (it != m_recordings->end())
   {
     Myth::ProgramPtr prog(it->second.GetPtr());
     lock.Unlock();
@@ -1321,8 +1555,8 @@ int PVRClientMythTV::GetRecordingLastPlayedPosition(const PVR_RECORDING &recordi
     XBMC->Log(LOG_DEBUG, "%s: Reading Bookmark for: %s", __FUNCTION__, recording.strTitle);
 
   CLockObject lock(m_recordingsLock);
-  ProgramInfoMap::iterator it = m_recordings.find(recording.strRecordingId);
-  if (it != m_recordings.end())
+  ProgramInfoMap::iterator it = FindRecording(recording.strRecordingId);
+  if (it != m_recordings->end())
   {
     if (it->second.HasBookmark())
     {
@@ -1348,9 +1582,25 @@ int PVRClientMythTV::GetRecordingLastPlayedPosition(const PVR_RECORDING &recordi
   return 0;
 }
 
+int PVRClientMythTV::GetEdlUnit() const
+{
+  // Marks are based on framecount until protocol 85, else on duration (ms)
+  return (m_control->CheckService() < 85 ? 0 : 2);
+}
+
+void PVRClientMythTV::PrefetchRecordingEdl(const MythProgramInfo& programInfo)
+{
+  if (!g_bPrefetchEDL || g_iEnableEDL == ENABLE_EDL_NEVER || !m_edlCache)
+    return;
+  // Marks are not complete until the end of recording
+  if (programInfo.Status() == Myth::RS_RECORDING || programInfo.Status() == Myth::RS_TUNING)
+    return;
+  m_edlCache->Prefetch(programInfo, GetEdlUnit());
+}
+
 PVR_ERROR PVRClientMythTV::GetRecordingEdl(const PVR_RECORDING &recording, PVR_EDL_ENTRY entries[], int *size)
 {
-  if (!m_control)
+  if (!m_control || !m_edlCache)
     return PVR_ERROR_SERVER_ERROR;
   *size = 0;
   if (g_iEnableEDL == ENABLE_EDL_NEVER)
@@ -1361,8 +1611,8 @@ PVR_ERROR PVRClientMythTV::GetRecordingEdl(const PVR_RECORDING &recording, PVR_E
   MythProgramInfo prog;
   {
     CLockObject lock(m_recordingsLock);
-    ProgramInfoMap::iterator it = m_recordings.find(recording.strRecordingId);
-    if (it == m_recordings.end())
+    ProgramInfoMap::iterator it = FindRecording(recording.strRecordingId);
+    if (it == m_recordings->end())
     {
       XBMC->Log(LOG_ERROR, "%s: Recording %s does not exist", __FUNCTION__, recording.strRecordingId);
       return PVR_ERROR_INVALID_PARAMETERS;
@@ -1371,23 +1621,27 @@ PVR_ERROR PVRClientMythTV::GetRecordingEdl(const PVR_RECORDING &recording, PVR_E
   }
 
   // Checking backend capabilities
-  int unit = 2; // default unit is duration (ms)
+  int unit = GetEdlUnit();
   float rate = 1000.0f;
-  if (m_control->CheckService() < 85)
+  if (unit == 0)
   {
-    unit = 0; // marks are based on framecount
+    // marks are based on framecount
     // Check required props else return
     rate = prog.GetPropsVideoFrameRate();
+    // The probe could be running along with playback start
+    if (rate <= 0 && m_avinfoCache && m_avinfoCache->WaitProbed(prog, c_edlProbeTimeout))
+      rate = prog.GetPropsVideoFrameRate();
     XBMC->Log(LOG_DEBUG, "%s: AV props: Frame Rate = %.3f", __FUNCTION__, rate);
     if (rate <= 0)
       return PVR_ERROR_NO_ERROR;
   }
 
-  // Search for marks with defined unit
-  Myth::MarkListPtr skpList = m_control->GetCommBreakList(*(prog.GetPtr()), unit);
-  XBMC->Log(LOG_DEBUG, "%s: Found %d commercial breaks for: %s", __FUNCTION__, skpList->size(), recording.strTitle);
-  Myth::MarkListPtr cutList = m_control->GetCutList(*(prog.GetPtr()), unit);
+  // Search for marks with defined unit. Cached lists are shared so copy them.
+  Myth::MarkListPtr brkList, cutList;
+  m_edlCache->GetMarks(prog, unit, brkList, cutList);
+  XBMC->Log(LOG_DEBUG, "%s: Found %d commercial breaks for: %s", __FUNCTION__, brkList->size(), recording.strTitle);
   XBMC->Log(LOG_DEBUG, "%s: Found %d cut list entries for: %s", __FUNCTION__, cutList->size(), recording.strTitle);
+  Myth::MarkListPtr skpList(new Myth::MarkList(*brkList));
   skpList->insert(skpList->end(), cutList->begin(), cutList->end());
   // Open dialog
   if (g_iEnableEDL == ENABLE_EDL_DIALOG && !skpList->empty())
@@ -1461,8 +1715,8 @@ PVR_ERROR PVRClientMythTV::UndeleteRecording(const PVR_RECORDING &recording)
 
   CLockObject lock(m_recordingsLock);
 
-  ProgramInfoMap::iterator it = m_recordings.find(recording.strRecordingId);
-  if (it != m_recordings.end())
+  ProgramInfoMap::iterator it = FindRecording(recording.strRecordingId);
+  if (it != m_recordings->end())
   {
     bool ret = m_control->UndeleteRecording(*(it->second.GetPtr()));
     if (ret)
@@ -1492,16 +1746,16 @@ PVR_ERROR PVRClientMythTV::PurgeDeletedRecordings()
 
   CLockObject lock(m_recordingsLock);
 
-  for (ProgramInfoMap::iterator it = m_recordings.begin(); it != m_recordings.end(); ++it)
+  for (ProgramInfoMap::iterator it = m_recordings->begin(); it != m_recordings->end(); ++it)
   {
     if (!it->second.IsNull() && it->second.IsDeleted())
     {
       if (m_control->DeleteRecording(*(it->second.GetPtr())))
-        XBMC->Log(LOG_DEBUG, "%s: Deleted recording %s", __FUNCTION__, it->first.c_str());
+        XBMC->Log(LOG_DEBUG, "%s: Deleted recording %s", __FUNCTION__, it->second.UID().c_str());
       else
       {
         err = true;
-        XBMC->Log(LOG_ERROR, "%s: Failed to delete recording %s", __FUNCTION__, it->first.c_str());
+        XBMC->Log(LOG_ERROR, "%s: Failed to delete recording %s", __FUNCTION__, it->second.UID().c_str());
       }
     }
   }
@@ -1519,8 +1773,8 @@ bool PVRClientMythTV::IsMyLiveRecording(const MythProgramInfo& programInfo)
 {
   if (!programInfo.IsNull())
   {
-    // Begin critical section
-    CLockObject lock(m_lock);
+    // It guards the deletion of the live recording: wait for the live session
+    CLockObject lock(m_liveLock);
     if (m_liveStream && m_liveStream->IsPlaying())
     {
       MythProgramInfo live(m_liveStream->GetPlayedProgram());
@@ -1536,9 +1790,8 @@ int PVRClientMythTV::GetTimersAmount(void)
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s", __FUNCTION__);
 
-  if (m_scheduleManager)
-    return m_scheduleManager->GetUpcomingCount();
-  return 0;
+  TimersDataPtr timers = GetTimersData();
+  return (int)timers->timers.size();
 }
 
 PVR_ERROR PVRClientMythTV::GetTimers(ADDON_HANDLE handle)
@@ -1546,12 +1799,37 @@ PVR_ERROR PVRClientMythTV::GetTimers(ADDON_HANDLE handle)
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s", __FUNCTION__);
 
-  MythTimerEntryList entries;
+  TimersDataPtr timers = GetTimersData();
+  for (std::vector<PVR_TIMER>::const_iterator it = timers->timers.begin(); it != timers->timers.end(); ++it)
   {
-    CLockObject lock(m_lock);
-    if (m_scheduleManager)
-      entries = m_scheduleManager->GetTimerEntries();
+    PVR_TIMER tag = *it;
+    PVR->TransferTimerEntry(handle, &tag);
   }
+
+  if (g_bExtraDebug)
+    XBMC->Log(LOG_DEBUG, "%s: Done", __FUNCTION__);
+
+  return PVR_ERROR_NO_ERROR;
+}
+
+PVRClientMythTV::TimersDataPtr PVRClientMythTV::GetTimersData()
+{
+  CLockObject lock(m_scheduleLock);
+  unsigned version = (m_scheduleManager ? m_scheduleManager->GetVersion() : 0);
+  ChannelsDataPtr channels = GetChannelsData();
+  // The timers depend on the schedule, the filter of rules and the channel uids
+  if (m_timers && m_timers->scheduleVersion == version && m_timers->showNotRecording == g_bShowNotRecording &&
+          m_timers->channels.get() == channels.get())
+    return m_timers;
+
+  TimersData *data = new TimersData();
+  data->scheduleVersion = version;
+  data->showNotRecording = g_bShowNotRecording;
+  data->channels = channels;
+  MythTimerEntryList entries;
+  if (m_scheduleManager)
+    entries = m_scheduleManager->GetTimerEntries();
+  data->timers.reserve(entries.size());
   for (MythTimerEntryList::const_iterator it = entries.begin(); it != entries.end(); ++it)
   {
     PVR_TIMER tag;
@@ -1674,17 +1952,16 @@ PVR_ERROR PVRClientMythTV::GetTimers(ADDON_HANDLE handle)
     tag.iGenreType = genre & 0xF0;
     tag.iGenreSubType = genre & 0x0F;
 
-    PVR->TransferTimerEntry(handle, &tag);
+    data->timers.push_back(tag);
     if (g_bExtraDebug)
       XBMC->Log(LOG_DEBUG, "%s: #%u: IN=%d RS=%d type %u state %d parent %u autoexpire %d", __FUNCTION__,
               tag.iClientIndex, (*it)->isInactive, (*it)->recordingStatus,
               tag.iTimerType, (int)tag.state, tag.iParentClientIndex, tag.iLifetime);
   }
-
+  m_timers.reset(data);
   if (g_bExtraDebug)
-    XBMC->Log(LOG_DEBUG, "%s: Done", __FUNCTION__);
-
-  return PVR_ERROR_NO_ERROR;
+    XBMC->Log(LOG_DEBUG, "%s: Built %u timers of schedule version %u", __FUNCTION__, (unsigned)data->timers.size(), version);
+  return m_timers;
 }
 
 PVR_ERROR PVRClientMythTV::AddTimer(const PVR_TIMER &timer)
@@ -1718,44 +1995,57 @@ PVR_ERROR PVRClientMythTV::AddTimer(const PVR_TIMER &timer)
     XBMC->Log(LOG_DEBUG, "%s: iRecordingGroup = %d", __FUNCTION__, timer.iRecordingGroup);
   }
   XBMC->Log(LOG_DEBUG, "%s: title: %s, start: %ld, end: %ld, chanID: %u", __FUNCTION__, timer.strTitle, timer.startTime, timer.endTime, timer.iClientChannelUid);
-  CLockObject lock(m_lock);
-  // Check if our timer is a quick recording of live tv
-  // Assumptions: Our live recorder is locked on the same channel and the recording starts
-  // at the same time as or before (includes 0) the currently in progress program
-  // If true then keep recording, setup recorder and let the backend handle the rule.
-  if (m_liveStream && m_liveStream->IsPlaying())
-  {
-    Myth::ProgramPtr program = m_liveStream->GetPlayedProgram();
-    if (timer.iClientChannelUid == FindPVRChannelUid(program->channel.chanId) &&
-        timer.startTime <= program->startTime)
-    {
-      XBMC->Log(LOG_DEBUG, "%s: Timer is a quick recording. Toggling Record on", __FUNCTION__);
-      if (m_liveStream->IsLiveRecording())
-        XBMC->Log(LOG_NOTICE, "%s: Record already on! Retrying...", __FUNCTION__);
-      else
+  {
+    CLockObject lock(m_liveLock);
+    // Check if our timer is a quick recording of live tv
+    // Assumptions: Our live recorder is locked on the same channel and the recording starts
+    // at the same time as or before (includes 0) the currently in progress program
+    // If true then keep recording, setup recorder and let the backend handle the rule.
+    if (m_liveStream && m_liveStream->IsPlaying())
+    {
+      Myth::ProgramPtr program = m_liveStream->GetPlayedProgram();
+      if (timer.iClientChannelUid == FindPVRChannelUid(program->channel.chanId) &&
+          timer.startTime <= program->startTime)
       {
-        // Add bookmark for the current stream position
-        m_control->SetSavedBookmark(*program, 1, m_liveStream->GetPosition());
+        XBMC->Log(LOG_DEBUG, "%s: Timer is a quick recording. Toggling Record on", __FUNCTION__);
+        if (m_liveStream->IsLiveRecording())
+          XBMC->Log(LOG_NOTICE, "%s: Record already on! Retrying...", __FUNCTION__);
+        else
+        {
+          // Add bookmark for the current stream position
+          m_control->SetSavedBookmark(*program, 1, m_liveStream->GetPosition());
+        }
+        if (m_liveStream->KeepLiveRecording(true))
+          return PVR_ERROR_NO_ERROR;
+        else
+          // Supress error notification! XBMC locks if we return an error here.
+          return PVR_ERROR_NO_ERROR;
       }
-      if (m_liveStream->KeepLiveRecording(true))
-        return PVR_ERROR_NO_ERROR;
-      else
-        // Supress error notification! XBMC locks if we return an error here.
-        return PVR_ERROR_NO_ERROR;
     }
   }
 
   // Otherwise submit the new timer
   XBMC->Log(LOG_DEBUG, "%s: Submitting new timer", __FUNCTION__);
   MythTimerEntry entry = PVRtoTimerEntry(timer, true);
-  MythScheduleManager::MSM_ERROR ret = m_scheduleManager->SubmitTimer(entry);
+  // Preview the airings of a text search from the local guide until the backend schedules them
+  Myth::ProgramList preview;
+  if (entry.timerType == TIMER_TYPE_SEARCH_TEXT && !entry.epgSearch.empty())
+  {
+    unsigned fields = GuideIndex::FieldTitle;
+    if (entry.isFullTextEpgSearch)
+      fields |= GuideIndex::FieldSubtitle | GuideIndex::FieldDescription;
+    preview = m_guideIndex.Search(entry.epgSearch, fields, (entry.HasChannel() ? entry.chanid : 0));
+    XBMC->Log(LOG_DEBUG, "%s: Found %u airings in the guide for '%s'", __FUNCTION__, (unsigned)preview.size(), entry.epgSearch.c_str());
+  }
+  MythScheduleManager::MSM_ERROR ret = m_scheduleManager->SubmitTimer(entry, preview);
   if (ret == MythScheduleManager::MSM_ERROR_FAILED)
     return PVR_ERROR_FAILED;
   if (ret == MythScheduleManager::MSM_ERROR_NOT_IMPLEMENTED)
     return PVR_ERROR_REJECTED;
 
-  // Completion of the scheduling will be signaled by a SCHEDULE_CHANGE event.
-  // Thus no need to call TriggerTimerUpdate().
+  // The schedule manager applied the change locally. Completion of the scheduling
+  // will be signaled by a SCHEDULE_CHANGE event, that reconciles the timers.
+  PVR->TriggerTimerUpdate();
   return PVR_ERROR_NO_ERROR;
 }
 
@@ -1773,7 +2063,7 @@ PVR_ERROR PVRClientMythTV::DeleteTimer(const PVR_TIMER &timer, bool force)
   // Assumptions: Recorder handle same recording.
   // If true then expire recording, setup recorder and let backend handle the rule.
   {
-    CLockObject lock(m_lock);
+    CLockObject lock(m_liveLock);
     if (m_liveStream && m_liveStream->IsLiveRecording())
     {
       MythRecordingRuleNodePtr node = m_scheduleManager->FindRuleByIndex(timer.iClientIndex);
@@ -1802,6 +2092,7 @@ PVR_ERROR PVRClientMythTV::DeleteTimer(const PVR_TIMER &timer, bool force)
   if (ret == MythScheduleManager::MSM_ERROR_NOT_IMPLEMENTED)
     return PVR_ERROR_NOT_IMPLEMENTED;
 
+  PVR->TriggerTimerUpdate();
   return PVR_ERROR_NO_ERROR;
 }
 
@@ -1891,11 +2182,10 @@ MythTimerEntry PVRClientMythTV::PVRtoTimerEntry(const PVR_TIMER& timer, bool che
     unsigned bid;
     time_t bst;
     MythEPGInfo::BreakBroadcastID(timer.iEpgUid, &bid, &bst);
-    Myth::ProgramMapPtr epg = m_control->GetProgramGuide(bid, bst, bst);
-    Myth::ProgramMap::reverse_iterator epgit = epg->rbegin(); // Get last found
-    if (epgit != epg->rend())
+    Myth::ProgramPtr program = FindGuideProgram(bid, bst);
+    if (program)
     {
-      entry.epgInfo = MythEPGInfo(epgit->second);
+      entry.epgInfo = MythEPGInfo(program);
       XBMC->Log(LOG_DEBUG,"%s: Found EPG program: %s (%s) %s (%s)", __FUNCTION__,
                           entry.epgInfo.ProgramID().c_str(), entry.epgInfo.SeriesID().c_str(),
                           entry.epgInfo.Title().c_str(), entry.epgInfo.Subtitle().c_str());
@@ -1994,6 +2284,7 @@ PVR_ERROR PVRClientMythTV::UpdateTimer(const PVR_TIMER &timer)
     return PVR_ERROR_FAILED;
   if (ret == MythScheduleManager::MSM_ERROR_NOT_IMPLEMENTED)
     return PVR_ERROR_NOT_IMPLEMENTED;
+  PVR->TriggerTimerUpdate();
 
   XBMC->Log(LOG_DEBUG,"%s: Done", __FUNCTION__);
   return PVR_ERROR_NO_ERROR;
@@ -2004,7 +2295,7 @@ PVR_ERROR PVRClientMythTV::GetTimerTypes(PVR_TIMER_TYPE types[], int *size)
   unsigned index = 0;
   if (m_scheduleManager)
   {
-    CLockObject lock(m_lock);
+    CLockObject lock(m_scheduleLock);
     MythTimerTypeList typeList = m_scheduleManager->GetTimerTypes();
     assert(typeList.size() <= static_cast<unsigned>(*size));
     for (MythTimerTypeList::const_iterator it = typeList.begin(); it != typeList.end(); ++it)
@@ -2029,13 +2320,18 @@ bool PVRClientMythTV::OpenLiveStream(const PVR_CHANNEL &channel)
     XBMC->Log(LOG_DEBUG,"%s: channel uid: %u, num: %u", __FUNCTION__, channel.iUniqueId, channel.iChannelNumber);
 
   // Begin critical section
-  CLockObject lock(m_lock);
+  CLockObject lock(m_liveLock);
   // First we have to get merged channels for the selected channel
   Myth::ChannelList chanset;
-  for (PVRChannelMap::const_iterator it = m_PVRChannelUidById.begin(); it != m_PVRChannelUidById.end(); ++it)
+  ChannelsDataPtr channels = GetChannelsData();
+  for (PVRChannelMap::const_iterator it = channels->PVRChannelUidById.begin(); it != channels->PVRChannelUidById.end(); ++it)
   {
     if (it->second == channel.iUniqueId)
-      chanset.push_back(FindChannel(it->first).GetPtr());
+    {
+      ChannelIdMap::const_iterator itm = channels->channelsById.find(it->first);
+      if (itm != channels->channelsById.end())
+        chanset.push_back(itm->second.GetPtr());
+    }
   }
 
   if (chanset.empty())
@@ -2051,6 +2347,9 @@ bool PVRClientMythTV::OpenLiveStream(const PVR_CHANNEL &channel)
   // Suspend fileOps to avoid connection hang
   if (m_fileOps)
     m_fileOps->Suspend();
+  // Pause background probing to keep the bandwidth for playback
+  if (m_avinfoCache)
+    m_avinfoCache->PauseBackground();
   // Configure tuning of channel
   m_liveStream->SetTuneDelay(g_iTuneDelay);
   m_liveStream->SetLimitTuneAttempts(g_bLimitTuneAttempts);
@@ -2065,6 +2364,9 @@ bool PVRClientMythTV::OpenLiveStream(const PVR_CHANNEL &channel)
   // Resume fileOps
   if (m_fileOps)
     m_fileOps->Resume();
+  // Resume background probing
+  if (m_avinfoCache)
+    m_avinfoCache->ResumeBackground();
   XBMC->Log(LOG_ERROR,"%s: Failed to open live stream", __FUNCTION__);
   // Open the dummy stream 'CHANNEL UNAVAILABLE'
   if (!m_dummyStream)
@@ -2084,13 +2386,16 @@ void PVRClientMythTV::CloseLiveStream()
     XBMC->Log(LOG_DEBUG, "%s", __FUNCTION__);
 
   // Begin critical section
-  CLockObject lock(m_lock);
+  CLockObject lock(m_liveLock);
   // Destroy my stream
   SAFE_DELETE(m_liveStream);
   SAFE_DELETE(m_dummyStream);
   // Resume fileOps
   if (m_fileOps)
     m_fileOps->Resume();
+  // Resume background probing
+  if (m_avinfoCache)
+    m_avinfoCache->ResumeBackground();
 
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s: Done", __FUNCTION__);
@@ -2112,7 +2417,7 @@ bool PVRClientMythTV::SwitchChannel(const PVR_CHANNEL &channel)
     XBMC->Log(LOG_DEBUG,"%s: chanid: %u, channum: %u", __FUNCTION__, channel.iUniqueId, channel.iChannelNumber);
 
   // Begin critical section
-  CLockObject lock(m_lock);
+  CLockObject lock(m_liveLock);
   // Stop the live for reopening
   if (m_liveStream)
     m_liveStream->StopLiveTV();
@@ -2182,8 +2487,9 @@ PVR_ERROR PVRClientMythTV::SignalStatus(PVR_SIGNAL_STATUS &signalStatus)
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s", __FUNCTION__);
 
-  CLockObject lock(m_lock);
-  if (!m_liveStream)
+  // Don't wait for a tuning in progress: no status is available until done
+  CTryLockObject lock(m_liveLock);
+  if (!lock.IsLocked() || !m_liveStream)
     return PVR_ERROR_SERVER_ERROR;
 
   char buf[50];
@@ -2215,17 +2521,17 @@ time_t PVRClientMythTV::GetPlayingTime()
 
 time_t PVRClientMythTV::GetBufferTimeStart()
 {
-  CLockObject lock(m_lock);
-  if (!m_liveStream || !m_liveStream->IsPlaying())
+  CTryLockObject lock(m_liveLock);
+  if (!lock.IsLocked() || !m_liveStream || !m_liveStream->IsPlaying())
     return 0;
   return m_liveStream->GetLiveTimeStart();
 }
 
 time_t PVRClientMythTV::GetBufferTimeEnd()
 {
-  CLockObject lock(m_lock);
+  CTryLockObject lock(m_liveLock);
   unsigned count;
-  if (!m_liveStream || !(count = m_liveStream->GetChainedCount()))
+  if (!lock.IsLocked() || !m_liveStream || !(count = m_liveStream->GetChainedCount()))
     return (time_t)(-1);
   time_t now = time(NULL);
   MythProgramInfo prog = MythProgramInfo(m_liveStream->GetChainedProgram(count));
@@ -2240,7 +2546,7 @@ bool PVRClientMythTV::OpenRecordedStream(const PVR_RECORDING &recording)
     XBMC->Log(LOG_DEBUG, "%s: title: %s, ID: %s, duration: %d", __FUNCTION__, recording.strTitle, recording.strRecordingId, recording.iDuration);
 
   // Begin critical section
-  CLockObject lock(m_lock);
+  CLockObject lock(m_recordedLock);
   if (m_recordingStream)
   {
     XBMC->Log(LOG_NOTICE, "%s: Recorded stream is busy", __FUNCTION__);
@@ -2250,8 +2556,8 @@ bool PVRClientMythTV::OpenRecordedStream(const PVR_RECORDING &recording)
   MythProgramInfo prog;
   {
     CLockObject lock(m_recordingsLock);
-    ProgramInfoMap::iterator it = m_recordings.find(recording.strRecordingId);
-    if (it == m_recordings.end())
+    ProgramInfoMap::iterator it = FindRecording(recording.strRecordingId);
+    if (it == m_recordings->end())
     {
       XBMC->Log(LOG_ERROR, "%s: Recording %s does not exist", __FUNCTION__, recording.strRecordingId);
       return false;
@@ -2262,6 +2568,9 @@ bool PVRClientMythTV::OpenRecordedStream(const PVR_RECORDING &recording)
   // Suspend fileOps to avoid connection hang
   if (m_fileOps)
     m_fileOps->Suspend();
+  // Pause background probing to keep the bandwidth for playback
+  if (m_avinfoCache)
+    m_avinfoCache->PauseBackground();
 
   if (prog.HostName() == m_control->GetServerHostName())
   {
@@ -2273,8 +2582,8 @@ bool PVRClientMythTV::OpenRecordedStream(const PVR_RECORDING &recording)
     {
       if (g_bExtraDebug)
         XBMC->Log(LOG_DEBUG, "%s: Done", __FUNCTION__);
-      // Fill AV info for later use
-      FillRecordingAVInfo(prog, m_recordingStream);
+      // Fill AV info for later use, concurrently with playback
+      RequestRecordingAVInfo(prog);
       return true;
     }
   }
@@ -2291,8 +2600,8 @@ bool PVRClientMythTV::OpenRecordedStream(const PVR_RECORDING &recording)
       {
         if (g_bExtraDebug)
           XBMC->Log(LOG_DEBUG, "%s: Done", __FUNCTION__);
-        // Fill AV info for later use
-        FillRecordingAVInfo(prog, m_recordingStream);
+        // Fill AV info for later use, concurrently with playback
+        RequestRecordingAVInfo(prog);
         return true;
       }
       SAFE_DELETE(m_recordingStream);
@@ -2318,8 +2627,9 @@ bool PVRClientMythTV::OpenRecordedStream(const PVR_RECORDING &recording)
     {
       if (g_bExtraDebug)
         XBMC->Log(LOG_DEBUG, "%s: Done", __FUNCTION__);
-      // Fill AV info for later use
-      FillRecordingAVInfo(prog, m_recordingStream);
+      // Fill AV info for later use. The prober can't reach this slave backend.
+      if (prog.GetPropsVideoFrameRate() <= 0)
+        FillRecordingAVInfo(prog, m_recordingStream);
       return true;
     }
   }
@@ -2328,6 +2638,9 @@ bool PVRClientMythTV::OpenRecordedStream(const PVR_RECORDING &recording)
   // Resume fileOps
   if (m_fileOps)
     m_fileOps->Resume();
+  // Resume background probing
+  if (m_avinfoCache)
+    m_avinfoCache->ResumeBackground();
   XBMC->Log(LOG_ERROR,"%s: Failed to open recorded stream", __FUNCTION__);
   return false;
 }
@@ -2338,12 +2651,15 @@ void PVRClientMythTV::CloseRecordedStream()
     XBMC->Log(LOG_DEBUG, "%s", __FUNCTION__);
 
   // Begin critical section
-  CLockObject lock(m_lock);
+  CLockObject lock(m_recordedLock);
   // Destroy my stream
   SAFE_DELETE(m_recordingStream);
   // Resume fileOps
   if (m_fileOps)
     m_fileOps->Resume();
+  // Resume background probing
+  if (m_avinfoCache)
+    m_avinfoCache->ResumeBackground();
 
   if (g_bExtraDebug)
     XBMC->Log(LOG_DEBUG, "%s: Done", __FUNCTION__);
@@ -2414,18 +2730,23 @@ PVR_ERROR PVRClientMythTV::CallMenuHook(const PVR_MENUHOOK &menuhook, const PVR_
 
   if (menuhook.iHookId == MENUHOOK_KEEP_RECORDING && item.cat == PVR_MENUHOOK_RECORDING)
   {
-    CLockObject lock(m_recordingsLock);
-    ProgramInfoMap::iterator it = m_recordings.find(item.data.recording.strRecordingId);
-    if (it == m_recordings.end())
+    MythProgramInfo prog;
+    {
+      CLockObject lock(m_recordingsLock);
+      ProgramInfoMap::iterator it = FindRecording(item.data.recording.strRecordingId);
+      if (it != m_recordings->end())
+        prog = it->second;
+    }
+    if (prog.IsNull())
     {
       XBMC->Log(LOG_ERROR,"%s: Recording not found", __FUNCTION__);
       return PVR_ERROR_INVALID_PARAMETERS;
     }
 
     // If recording is current live show then keep it and set live recorder
-    if (IsMyLiveRecording(it->second))
+    if (IsMyLiveRecording(prog))
     {
-      CLockObject lock(m_lock);
+      CLockObject lock(m_liveLock);
       if (m_liveStream && m_liveStream->KeepLiveRecording(true))
         return PVR_ERROR_NO_ERROR;
       return PVR_ERROR_FAILED;
@@ -2433,10 +2754,10 @@ PVR_ERROR PVRClientMythTV::CallMenuHook(const PVR_MENUHOOK &menuhook, const PVR_
     // Else keep recording
     else
     {
-      if (m_control->UndeleteRecording(*(it->second.GetPtr())))
+      if (m_control->UndeleteRecording(*(prog.GetPtr())))
       {
         std::string info = XBMC->GetLocalizedString(menuhook.iLocalizedStringId);
-        info.append(": ").append(it->second.Title());
+        info.append(": ").append(prog.Title());
         XBMC->QueueNotification(QUEUE_INFO, info.c_str());
         return PVR_ERROR_NO_ERROR;
       }
@@ -2504,11 +2825,10 @@ PVR_ERROR PVRClientMythTV::CallMenuHook(const PVR_MENUHOOK &menuhook, const PVR_
     unsigned int chanid;
     MythEPGInfo::BreakBroadcastID(item.data.iEpgUid, &chanid, &attime);
     MythEPGInfo epgInfo;
-    Myth::ProgramMapPtr epg = m_control->GetProgramGuide(chanid, attime, attime);
-    Myth::ProgramMap::reverse_iterator epgit = epg->rbegin(); // Get last found
-    if (epgit != epg->rend())
+    Myth::ProgramPtr program = FindGuideProgram(chanid, attime);
+    if (program)
     {
-      epgInfo = MythEPGInfo(epgit->second);
+      epgInfo = MythEPGInfo(program);
       if (g_bExtraDebug)
         XBMC->Log(LOG_DEBUG, "%s: Found EPG program (%d) chanid: %u attime: %lu", __FUNCTION__, item.data.iEpgUid, chanid, attime);
       //if (m_scheduleManager)
@@ -2584,29 +2904,29 @@ std::string PVRClientMythTV::MakeProgramTitle(const std::string& title, const st
 
 void PVRClientMythTV::FillRecordingAVInfo(MythProgramInfo& programInfo, Myth::Stream *stream)
 {
-  AVInfo info(stream);
-  AVInfo::STREAM_AVINFO mInfo;
-  if (info.GetMainStream(&mInfo))
+  float fps = 0, aspec = 0;
+  if (AVInfoCache::Probe(stream, fps, aspec))
   {
     // Set video frame rate
-    if (mInfo.stream_info.fps_scale > 0)
-    {
-      float fps = 0;
-      switch(mInfo.stream_type)
-      {
-        case TSDemux::STREAM_TYPE_VIDEO_H264:
-          fps = (float)(mInfo.stream_info.fps_rate) / (mInfo.stream_info.fps_scale * (mInfo.stream_info.interlaced ? 2 : 1));
-          break;
-        default:
-          fps = (float)(mInfo.stream_info.fps_rate) / mInfo.stream_info.fps_scale;
-      }
+    if (fps > 0)
       programInfo.SetPropsVideoFrameRate(fps);
-    }
     // Set video aspec
-    programInfo.SetPropsVideoAspec(mInfo.stream_info.aspect);
+    programInfo.SetPropsVideoAspec(aspec);
+    // Keep them for the next sessions
+    if (m_avinfoCache)
+      m_avinfoCache->Store(programInfo);
   }
 }
 
+void PVRClientMythTV::RequestRecordingAVInfo(MythProgramInfo& programInfo)
+{
+  if (!m_avinfoCache)
+    return;
+  if (programInfo.GetPropsVideoFrameRate() > 0 || m_avinfoCache->Apply(programInfo))
+    return;
+  m_avinfoCache->Request(programInfo);
+}
+
 time_t PVRClientMythTV::GetRecordingTime(time_t airtt, time_t recordingtt)
 {
   if (!g_bUseAirdate || airtt == 0)
@@ -25,6 +25,13 @@
 #include "fileOps.h"
 #include "categories.h"
 #include "filestreaming.h"
+#include "recordingsSnapshot.h"
+#include "recordingsJournal.h"
+#include "recordingsIndex.h"
+#include "avinfoCache.h"
+#include "edlCache.h"
+#include "scheduleUpdater.h"
+#include "guideIndex.h"
 
 #include <xbmc_pvr_types.h>
 #include <p8-platform/threads/mutex.h>
@@ -39,7 +46,7 @@
 #include <vector>
 #include <map>
 
-class PVRClientMythTV : public Myth::EventSubscriber, FileConsumer
+class PVRClientMythTV : public Myth::EventSubscriber, RecordingsJournalConsumer, AVInfoConsumer, ScheduleUpdaterConsumer
 {
 public:
   PVRClientMythTV();
@@ -70,13 +77,21 @@ public:
   // Implements EventSubscriber
   void HandleBackendMessage(Myth::EventMessagePtr msg);
   void HandleChannelChange();
-  void HandleScheduleChange();
+  /// Reload the schedule. Unless forced, the timers are refreshed only when something changed.
+  void HandleScheduleChange(bool forceUpdate = true);
   void HandleAskRecording(const Myth::EventMessage& msg);
   void HandleRecordingListChange(const Myth::EventMessage& msg);
   void RunHouseKeeping();
 
-  // Implement FileConsumer
-  void HandleCleanedCache();
+  // Implement RecordingsJournalConsumer
+  void HandleRecordingReload();
+  void HandleRecordingChanges(const RecordingChangeList& changes);
+
+  // Implement AVInfoConsumer
+  void HandleAVInfoProbed(const MythProgramInfo& programInfo, float fps, float aspec);
+
+  // Implement ScheduleUpdaterConsumer
+  void HandleScheduleUpdate();
 
   // EPG
   PVR_ERROR GetEPGForChannel(ADDON_HANDLE handle, const PVR_CHANNEL &channel, time_t iStart, time_t iEnd);
@@ -159,14 +174,23 @@ private:
   // Backend
   FileOps *m_fileOps;
   MythScheduleManager *m_scheduleManager;
-  mutable P8PLATFORM::CMutex m_lock;
+  // The live session lock is held along the tuning, that could take seconds.
+  // Read-mostly accessors only try it and return defaults when it is busy.
+  mutable P8PLATFORM::CMutex m_liveLock;      ///< Live stream and dummy stream
+  mutable P8PLATFORM::CMutex m_recordedLock;  ///< Recording stream
+  mutable P8PLATFORM::CMutex m_scheduleLock;  ///< Timer entries and types of the schedule manager
+  ScheduleUpdater *m_scheduleUpdater;
 
   // Categories
   Categories m_categories;
 
+  // Guide
+  GuideIndex m_guideIndex;
+  /// Find the program airing on the channel at the given time, from the local guide else from the backend
+  Myth::ProgramPtr FindGuideProgram(uint32_t chanid, time_t attime);
+
   // Channels
   typedef std::map<unsigned int, MythChannel> ChannelIdMap;
-  ChannelIdMap m_channelsById;
   struct PVRChannelItem
   {
     unsigned int iUniqueId;
@@ -175,27 +199,100 @@ private:
   };
   typedef std::vector<PVRChannelItem> PVRChannelList;
   typedef std::map<std::string, PVRChannelList> PVRChannelGroupMap;
-  PVRChannelList m_PVRChannels;
-  PVRChannelGroupMap m_PVRChannelGroups;
   typedef std::map<unsigned int, unsigned int> PVRChannelMap;
-  PVRChannelMap m_PVRChannelUidById;
+  struct ChannelsData
+  {
+    ChannelIdMap channelsById;
+    PVRChannelList PVRChannels;
+    PVRChannelGroupMap PVRChannelGroups;
+    PVRChannelMap PVRChannelUidById;
+  };
+  typedef MYTH_SHARED_PTR<const ChannelsData> ChannelsDataPtr;
+  ChannelsDataPtr m_channels;           ///< Published version, replaced as a whole on refresh
   mutable P8PLATFORM::CMutex m_channelsLock;
+  ChannelsDataPtr GetChannelsData() const;
   int FillChannelsAndChannelGroups();
   MythChannel FindChannel(uint32_t channelId) const;
   int FindPVRChannelUid(uint32_t channelId) const;
 
+  // Timers
+  struct TimersData
+  {
+    unsigned scheduleVersion;
+    bool showNotRecording;
+    ChannelsDataPtr channels;           ///< Channels the uids were resolved with
+    std::vector<PVR_TIMER> timers;
+  };
+  typedef MYTH_SHARED_PTR<const TimersData> TimersDataPtr;
+  TimersDataPtr m_timers;               ///< Built once per version of the schedule, guarded by m_scheduleLock
+  TimersDataPtr GetTimersData();
+
   // Recordings
-  ProgramInfoMap m_recordings;
+  typedef MYTH_SHARED_PTR<ProgramInfoMap> ProgramInfoMapPtr;
+  ProgramInfoMapPtr m_recordings;       ///< Published version, never changed while readers hold it
   mutable P8PLATFORM::CMutex m_recordingsLock;
   unsigned m_recordingChangePinCount;
-  bool m_recordingsAmountChange;
-  int m_recordingsAmount;
-  bool m_deletedRecAmountChange;
-  int m_deletedRecAmount;
+  bool m_recordingsMerged;              ///< Recordings added by later merges are probed in background
+  RecordingsIndex m_recordingsIndex;    ///< Counters maintained along each change of the map
+  RecordingsSnapshot *m_recordingsSnapshot;
+  ProgramInfoMap& EditRecordings();     ///< Version to change with lock held, copied when shared
+  ProgramInfoMap::iterator FindRecording(const char *uid); ///< Lookup by the string id given to Kodi
   void ForceUpdateRecording(ProgramInfoMap::iterator it);
-  int FillRecordings();
+
+  /// Prebuilt content of PVR_RECORDING, cached along each recording entry
+  class RecordingTag : public MythProgramInfo::Cache
+  {
+  public:
+    // Context the tag was built for
+    unsigned generation;
+    mutable bool artworkEvicted; ///< A served artwork was evicted from the cache, guarded by m_recordingsLock
+    bool deleted;
+    bool serie;
+    int groupRecordings;
+    bool useAirdate;
+    // Content
+    std::string recordingId;
+    std::string title;
+    std::string episodeName;
+    std::string plot;
+    std::string channelName;
+    std::string directory;
+    std::string iconPath;
+    std::string thumbnailPath;
+    std::string fanartPath;
+    time_t recordingTime;
+    int duration;
+    int playCount;
+    int lastPlayedPosition;
+    int seriesNumber;
+    int episodeNumber;
+    int year;
+    int channelUid;
+    PVR_RECORDING_CHANNEL_TYPE channelType;
+    int genreType;
+    int genreSubType;
+    int epgEventId;
+    time_t epgEndTime;    ///< EPG entry is only given up to 1 day after the end
+  };
+  unsigned m_recordingTagGeneration;  ///< Bumped when channels change
+  RecordingsJournal *m_recordingsJournal;
+  AVInfoCache *m_avinfoCache;
+  static const unsigned c_edlProbeTimeout = 5000;  ///< Wait for a running probe of the frame rate
+  EdlCache *m_edlCache;
+  int GetEdlUnit() const;
+  void PrefetchRecordingEdl(const MythProgramInfo& programInfo);
+  static const unsigned c_maximumRecordingAdds = 10;  ///< Over this count of additions, fetch the whole list
+  typedef MythProgramInfo::CachePtr RecordingTagPtr; ///< Keeps a tag alive once its entry is replaced
+  bool CollectRecordingTags(ProgramInfoMap& recordings, bool deleted, bool build, std::vector<RecordingTagPtr>& tags);
+  bool IsRecordingTagValid(const RecordingTag *cached, bool deleted, bool serie) const;
+  void BuildRecordingTag(const MythProgramInfo& recording, bool deleted, bool serie);
+  static void FillRecordingTag(const RecordingTag& cached, time_t now, PVR_RECORDING& tag);
+  void TouchRecordingArtworks(const std::vector<RecordingTagPtr>& tags);
+  int FillRecordings(); ///< Merge the recorded list, returns the count of changes. Not to call with m_recordingsLock held.
+  ProgramInfoMapPtr MergeRecordedList(const ProgramInfoMap& base, Myth::ProgramList& programs, bool probeAdded,
+          int& added, int& updated, int& kept);
   MythChannel FindRecordingChannel(const MythProgramInfo& programInfo) const;
-  bool IsMyLiveRecording(const MythProgramInfo& programInfo);
+  bool IsMyLiveRecording(const MythProgramInfo& programInfo); ///< Waits for the live session, not to call with m_recordingsLock held
 
   // Timers
   MythTimerEntry PVRtoTimerEntry(const PVR_TIMER &timer, bool checkEPG);
@@ -212,7 +309,13 @@ private:
    *
    * \brief Parse and fill AV stream infos for a recorded program
    */
-  static void FillRecordingAVInfo(MythProgramInfo& programInfo, Myth::Stream *stream);
+  void FillRecordingAVInfo(MythProgramInfo& programInfo, Myth::Stream *stream);
+
+  /**
+   *
+   * \brief Ask the prober for AV stream infos of a recorded program unless known
+   */
+  void RequestRecordingAVInfo(MythProgramInfo& programInfo);
 
   /// Get the time that should be reported for this recording
   static time_t GetRecordingTime(time_t airdate, time_t startDate);
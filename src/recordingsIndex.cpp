@@ -0,0 +1,82 @@
+/*
+ *      Copyright (C) 2005-2014 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301 USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "recordingsIndex.h"
+
+RecordingsIndex::RecordingsIndex()
+: m_visible()
+, m_deleted()
+, m_titles()
+{
+}
+
+void RecordingsIndex::Clear()
+{
+  m_visible = Count();
+  m_deleted = Count();
+  m_titles.clear();
+}
+
+void RecordingsIndex::Rebuild(const ProgramInfoMap& recordings)
+{
+  Clear();
+  for (ProgramInfoMap::const_iterator it = recordings.begin(); it != recordings.end(); ++it)
+    Add(it->second);
+}
+
+void RecordingsIndex::Add(const MythProgramInfo& recording)
+{
+  Account(recording, 1);
+}
+
+void RecordingsIndex::Remove(const MythProgramInfo& recording)
+{
+  Account(recording, -1);
+}
+
+bool RecordingsIndex::IsSerie(const MythProgramInfo& recording, bool withLiveTV) const
+{
+  TitleMap::const_iterator it = m_titles.find(std::make_pair(recording.RecordingGroup(), recording.Title()));
+  return (it != m_titles.end() && it->second.Get(withLiveTV) > 1);
+}
+
+void RecordingsIndex::Account(const MythProgramInfo& recording, int delta)
+{
+  if (recording.IsNull())
+    return;
+  int liveTV = (recording.IsLiveTV() ? delta : 0);
+  if (recording.IsVisible())
+  {
+    m_visible.all += delta;
+    m_visible.liveTV += liveTV;
+    TitleMap::iterator it = m_titles.insert(std::make_pair(std::make_pair(recording.RecordingGroup(), recording.Title()), Count())).first;
+    it->second.all += delta;
+    it->second.liveTV += liveTV;
+    if (it->second.all <= 0)
+      m_titles.erase(it);
+  }
+  else if (recording.IsDeleted())
+  {
+    m_deleted.all += delta;
+    m_deleted.liveTV += liveTV;
+  }
+}
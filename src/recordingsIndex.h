@@ -0,0 +1,66 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2014 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301 USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "cppmyth/MythProgramInfo.h"
+
+#include <string>
+#include <map>
+
+/**
+ * Counters of the recordings map, maintained along each insert, update and
+ * delete of an entry. LiveTV recordings are counted apart so the counts
+ * follow the 'livetv_recordings' setting without a rescan.
+ */
+class RecordingsIndex
+{
+public:
+  RecordingsIndex();
+
+  void Clear();
+  void Rebuild(const ProgramInfoMap& recordings);
+  void Add(const MythProgramInfo& recording);
+  void Remove(const MythProgramInfo& recording);
+
+  int VisibleCount(bool withLiveTV) const { return m_visible.Get(withLiveTV); }
+  int DeletedCount(bool withLiveTV) const { return m_deleted.Get(withLiveTV); }
+  /// True when other visible recordings share the recording group and title
+  bool IsSerie(const MythProgramInfo& recording, bool withLiveTV) const;
+
+private:
+  struct Count
+  {
+    int all;
+    int liveTV;
+
+    Count() : all(0), liveTV(0) { }
+    int Get(bool withLiveTV) const { return (withLiveTV ? all : all - liveTV); }
+  };
+  typedef std::pair<std::string, std::string> TitleKey;   ///< recording group, title
+  typedef std::map<TitleKey, Count> TitleMap;
+
+  void Account(const MythProgramInfo& recording, int delta);
+
+  Count m_visible;
+  Count m_deleted;
+  TitleMap m_titles;
+};
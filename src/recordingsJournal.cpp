@@ -0,0 +1,161 @@
+/*
+ *      Copyright (C) 2005-2014 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301 USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "recordingsJournal.h"
+#include "client.h"
+#include "tools.h"
+
+using namespace ADDON;
+using namespace P8PLATFORM;
+
+RecordingsJournal::RecordingsJournal(RecordingsJournalConsumer *consumer)
+: CThread()
+, m_consumer(consumer)
+, m_changed()
+, m_reload(false)
+, m_changes()
+, m_order()
+{
+  CreateThread();
+}
+
+RecordingsJournal::~RecordingsJournal()
+{
+  StopThread(-1); // Set stopping. don't wait as we need to signal the thread first
+  m_changed.Signal();
+  StopThread(); // Wait for thread to stop
+}
+
+void RecordingsJournal::PushReload()
+{
+  CLockObject lock(m_lock);
+  m_reload = true;
+  m_changes.clear();
+  m_order.clear();
+  m_changed.Signal();
+}
+
+void RecordingsJournal::PushAdd(uint32_t chanid, time_t startts)
+{
+  RecordingChange change = { RecordingChange::ChangeAdd, 0, chanid, startts, Myth::ProgramPtr() };
+  Push(change);
+}
+
+void RecordingsJournal::PushAdd(uint32_t recordedid)
+{
+  RecordingChange change = { RecordingChange::ChangeAdd, recordedid, 0, 0, Myth::ProgramPtr() };
+  Push(change);
+}
+
+void RecordingsJournal::PushDelete(uint32_t chanid, time_t startts)
+{
+  RecordingChange change = { RecordingChange::ChangeDelete, 0, chanid, startts, Myth::ProgramPtr() };
+  Push(change);
+}
+
+void RecordingsJournal::PushDelete(uint32_t recordedid)
+{
+  RecordingChange change = { RecordingChange::ChangeDelete, recordedid, 0, 0, Myth::ProgramPtr() };
+  Push(change);
+}
+
+void RecordingsJournal::PushUpdate(Myth::ProgramPtr program)
+{
+  if (!program)
+    return;
+  RecordingChange change = { RecordingChange::ChangeUpdate, program->recording.recordedId, 0, 0, program };
+  // Without recorded id (protocol < 82) the recording is known by channel and start time
+  if (change.recordedId == 0)
+  {
+    change.chanId = program->channel.chanId;
+    change.startTs = program->recording.startTs;
+  }
+  Push(change);
+}
+
+void RecordingsJournal::Push(const RecordingChange& change)
+{
+  CLockObject lock(m_lock);
+  // A pending reload will catch up this change
+  if (m_reload)
+    return;
+  ChangeKey key = std::make_pair(change.recordedId, std::make_pair(change.chanId, change.startTs));
+  ChangeMap::iterator it = m_changes.find(key);
+  if (it == m_changes.end())
+  {
+    m_changes.insert(std::make_pair(key, change));
+    m_order.push_back(key);
+  }
+  else
+  {
+    switch (change.type)
+    {
+    case RecordingChange::ChangeUpdate:
+      // A pending add will fetch the latest program, and a pending delete wins
+      if (it->second.type == RecordingChange::ChangeUpdate)
+        it->second.program = change.program;
+      break;
+    default:
+      it->second = change;
+      break;
+    }
+  }
+  m_changed.Signal();
+}
+
+void *RecordingsJournal::Process()
+{
+  XBMC->Log(LOG_DEBUG, "%s: RecordingsJournal Thread Started", __FUNCTION__);
+
+  while (!IsStopped())
+  {
+    m_changed.Wait();
+    if (IsStopped())
+      break;
+
+    // Collect until the burst settles or the maximum delay expires
+    WaitBurstSettled(*this, m_changed, c_collectWindow, c_maximumDelay);
+    if (IsStopped())
+      break;
+
+    CLockObject lock(m_lock);
+    bool reload = m_reload;
+    RecordingChangeList changes;
+    changes.reserve(m_order.size());
+    for (std::vector<ChangeKey>::const_iterator it = m_order.begin(); it != m_order.end(); ++it)
+      changes.push_back(m_changes[*it]);
+    m_reload = false;
+    m_changes.clear();
+    m_order.clear();
+    lock.Unlock();
+
+    if (g_bExtraDebug)
+      XBMC->Log(LOG_DEBUG, "%s: Journal fetched: reload: %d, changes: %u", __FUNCTION__, (int)reload, (unsigned)changes.size());
+    if (reload)
+      m_consumer->HandleRecordingReload();
+    else if (!changes.empty())
+      m_consumer->HandleRecordingChanges(changes);
+  }
+
+  XBMC->Log(LOG_DEBUG, "%s: RecordingsJournal Thread Stopped", __FUNCTION__);
+  return NULL;
+}
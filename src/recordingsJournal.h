@@ -0,0 +1,96 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2014 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301 USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <mythtypes.h>
+#include <p8-platform/threads/threads.h>
+
+#include <vector>
+#include <map>
+
+/**
+ * A change of the recorded list, resolved by the consumer. A recording is
+ * identified by its recorded id when known, else by channel and start time.
+ */
+struct RecordingChange
+{
+  enum ChangeType
+  {
+    ChangeAdd,
+    ChangeUpdate,
+    ChangeDelete
+  };
+
+  ChangeType type;
+  uint32_t recordedId;
+  uint32_t chanId;
+  time_t startTs;
+  Myth::ProgramPtr program;   ///< Updated program for ChangeUpdate
+};
+
+typedef std::vector<RecordingChange> RecordingChangeList;
+
+class RecordingsJournalConsumer
+{
+public:
+  virtual ~RecordingsJournalConsumer() {};
+  virtual void HandleRecordingReload() = 0;
+  virtual void HandleRecordingChanges(const RecordingChangeList& changes) = 0;
+};
+
+/**
+ * Collects RECORDING_LIST_CHANGE events over a short window and hands them
+ * over to the consumer on its own thread, once deduplicated by recording.
+ * A reload request supersedes any pending change.
+ */
+class RecordingsJournal : public P8PLATFORM::CThread
+{
+public:
+  static const int c_collectWindow = 500;   // Wait 500ms for more changes before processing
+  static const int c_maximumDelay  = 3000;  // Don't delay processing more than 3s during a burst
+
+  RecordingsJournal(RecordingsJournalConsumer *consumer);
+  virtual ~RecordingsJournal();
+
+  void PushReload();
+  void PushAdd(uint32_t chanid, time_t startts);
+  void PushAdd(uint32_t recordedid);
+  void PushDelete(uint32_t chanid, time_t startts);
+  void PushDelete(uint32_t recordedid);
+  void PushUpdate(Myth::ProgramPtr program);
+
+protected:
+  void *Process();
+
+private:
+  typedef std::pair<uint32_t, std::pair<uint32_t, time_t> > ChangeKey;
+  typedef std::map<ChangeKey, RecordingChange> ChangeMap;
+
+  void Push(const RecordingChange& change);
+
+  RecordingsJournalConsumer *m_consumer;
+  P8PLATFORM::CMutex m_lock;
+  P8PLATFORM::CEvent m_changed;
+  bool m_reload;
+  ChangeMap m_changes;
+  std::vector<ChangeKey> m_order;   ///< Keys in order of first arrival
+};
@@ -0,0 +1,345 @@
+/*
+ *      Copyright (C) 2005-2014 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301 USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "recordingsSnapshot.h"
+#include "client.h"
+
+#include <cstring>
+
+#define SNAPSHOT_FILENAME     "recordings.dat"
+#define SNAPSHOT_MAGIC        "MYTHRECS"
+#define SNAPSHOT_MAGIC_LEN    8
+#define SNAPSHOT_BYTEORDER    0x01020304U   // Snapshot is written in host byte order
+#define SNAPSHOT_BUFFER_SIZE  32000
+#define SNAPSHOT_ENTRY_MIN    64            // Entries are larger: their times and string lengths alone exceed it
+
+using namespace ADDON;
+
+namespace
+{
+  class Writer
+  {
+  public:
+    Writer(std::string& buf) : m_buf(buf) { }
+
+    void Put(const void *data, size_t len) { m_buf.append(static_cast<const char*>(data), len); }
+    void PutU8(uint8_t v) { Put(&v, sizeof(v)); }
+    void PutU16(uint16_t v) { Put(&v, sizeof(v)); }
+    void PutU32(uint32_t v) { Put(&v, sizeof(v)); }
+    void PutI64(int64_t v) { Put(&v, sizeof(v)); }
+    void PutFloat(float v) { Put(&v, sizeof(v)); }
+    void PutTime(time_t v) { PutI64((int64_t)v); }
+    void PutString(const std::string& v)
+    {
+      PutU32((uint32_t)v.size());
+      Put(v.data(), v.size());
+    }
+
+  private:
+    std::string& m_buf;
+  };
+
+  class Reader
+  {
+  public:
+    Reader(const std::string& buf) : m_buf(buf), m_pos(0), m_ok(true) { }
+
+    bool IsOk() const { return m_ok; }
+    bool AtEnd() const { return m_pos >= m_buf.size(); }
+    size_t Remaining() const { return m_buf.size() - m_pos; }
+
+    bool Get(void *data, size_t len)
+    {
+      if (!m_ok || m_buf.size() - m_pos < len)
+        return (m_ok = false);
+      memcpy(data, m_buf.data() + m_pos, len);
+      m_pos += len;
+      return true;
+    }
+    uint8_t GetU8() { uint8_t v = 0; Get(&v, sizeof(v)); return v; }
+    uint16_t GetU16() { uint16_t v = 0; Get(&v, sizeof(v)); return v; }
+    uint32_t GetU32() { uint32_t v = 0; Get(&v, sizeof(v)); return v; }
+    int64_t GetI64() { int64_t v = 0; Get(&v, sizeof(v)); return v; }
+    float GetFloat() { float v = 0; Get(&v, sizeof(v)); return v; }
+    time_t GetTime() { return (time_t)GetI64(); }
+    std::string GetString()
+    {
+      uint32_t len = GetU32();
+      if (!m_ok || m_buf.size() - m_pos < len)
+      {
+        m_ok = false;
+        return std::string();
+      }
+      std::string v(m_buf.data() + m_pos, len);
+      m_pos += len;
+      return v;
+    }
+
+  private:
+    const std::string& m_buf;
+    size_t m_pos;
+    bool m_ok;
+  };
+
+  void WriteProgram(Writer& w, const Myth::Program& p)
+  {
+    w.PutTime(p.startTime);
+    w.PutTime(p.endTime);
+    w.PutString(p.title);
+    w.PutString(p.subTitle);
+    w.PutString(p.description);
+    w.PutU16(p.season);
+    w.PutU16(p.episode);
+    w.PutString(p.category);
+    w.PutString(p.catType);
+    w.PutString(p.hostName);
+    w.PutString(p.fileName);
+    w.PutI64(p.fileSize);
+    w.PutU8(p.repeat ? 1 : 0);
+    w.PutU32(p.programFlags);
+    w.PutString(p.seriesId);
+    w.PutString(p.programId);
+    w.PutString(p.inetref);
+    w.PutTime(p.lastModified);
+    w.PutString(p.stars);
+    w.PutTime(p.airdate);
+    w.PutU16(p.audioProps);
+    w.PutU16(p.videoProps);
+    w.PutU16(p.subProps);
+    // Channel
+    w.PutU32(p.channel.chanId);
+    w.PutString(p.channel.chanNum);
+    w.PutString(p.channel.callSign);
+    w.PutString(p.channel.iconURL);
+    w.PutString(p.channel.channelName);
+    w.PutU32(p.channel.mplexId);
+    w.PutString(p.channel.commFree);
+    w.PutString(p.channel.chanFilters);
+    w.PutU32(p.channel.sourceId);
+    w.PutU32(p.channel.inputId);
+    w.PutU8(p.channel.visible ? 1 : 0);
+    // Recording
+    w.PutU32(p.recording.recordId);
+    w.PutU32((uint32_t)p.recording.priority);
+    w.PutU8((uint8_t)p.recording.status);
+    w.PutU32(p.recording.encoderId);
+    w.PutU8(p.recording.recType);
+    w.PutU8(p.recording.dupInType);
+    w.PutU8(p.recording.dupMethod);
+    w.PutTime(p.recording.startTs);
+    w.PutTime(p.recording.endTs);
+    w.PutString(p.recording.profile);
+    w.PutString(p.recording.recGroup);
+    w.PutString(p.recording.storageGroup);
+    w.PutString(p.recording.playGroup);
+    w.PutU32(p.recording.recordedId);
+    // Artworks
+    w.PutU32((uint32_t)p.artwork.size());
+    for (std::vector<Myth::Artwork>::const_iterator it = p.artwork.begin(); it != p.artwork.end(); ++it)
+    {
+      w.PutString(it->url);
+      w.PutString(it->fileName);
+      w.PutString(it->storageGroup);
+      w.PutString(it->type);
+    }
+  }
+
+  void ReadProgram(Reader& r, Myth::Program& p)
+  {
+    p.startTime = r.GetTime();
+    p.endTime = r.GetTime();
+    p.title = r.GetString();
+    p.subTitle = r.GetString();
+    p.description = r.GetString();
+    p.season = r.GetU16();
+    p.episode = r.GetU16();
+    p.category = r.GetString();
+    p.catType = r.GetString();
+    p.hostName = r.GetString();
+    p.fileName = r.GetString();
+    p.fileSize = r.GetI64();
+    p.repeat = (r.GetU8() != 0);
+    p.programFlags = r.GetU32();
+    p.seriesId = r.GetString();
+    p.programId = r.GetString();
+    p.inetref = r.GetString();
+    p.lastModified = r.GetTime();
+    p.stars = r.GetString();
+    p.airdate = r.GetTime();
+    p.audioProps = r.GetU16();
+    p.videoProps = r.GetU16();
+    p.subProps = r.GetU16();
+    // Channel
+    p.channel.chanId = r.GetU32();
+    p.channel.chanNum = r.GetString();
+    p.channel.callSign = r.GetString();
+    p.channel.iconURL = r.GetString();
+    p.channel.channelName = r.GetString();
+    p.channel.mplexId = r.GetU32();
+    p.channel.commFree = r.GetString();
+    p.channel.chanFilters = r.GetString();
+    p.channel.sourceId = r.GetU32();
+    p.channel.inputId = r.GetU32();
+    p.channel.visible = (r.GetU8() != 0);
+    // Recording
+    p.recording.recordId = r.GetU32();
+    p.recording.priority = (int32_t)r.GetU32();
+    p.recording.status = (int8_t)r.GetU8();
+    p.recording.encoderId = r.GetU32();
+    p.recording.recType = r.GetU8();
+    p.recording.dupInType = r.GetU8();
+    p.recording.dupMethod = r.GetU8();
+    p.recording.startTs = r.GetTime();
+    p.recording.endTs = r.GetTime();
+    p.recording.profile = r.GetString();
+    p.recording.recGroup = r.GetString();
+    p.recording.storageGroup = r.GetString();
+    p.recording.playGroup = r.GetString();
+    p.recording.recordedId = r.GetU32();
+    // Artworks
+    uint32_t count = r.GetU32();
+    for (uint32_t i = 0; i < count && r.IsOk(); ++i)
+    {
+      Myth::Artwork artwork;
+      artwork.url = r.GetString();
+      artwork.fileName = r.GetString();
+      artwork.storageGroup = r.GetString();
+      artwork.type = r.GetString();
+      p.artwork.push_back(artwork);
+    }
+  }
+}
+
+RecordingsSnapshot::RecordingsSnapshot(const std::string& backend, unsigned serviceVersion)
+: m_filePath(g_szUserPath + SNAPSHOT_FILENAME)
+, m_backend(backend)
+, m_serviceVersion(serviceVersion)
+{
+}
+
+bool RecordingsSnapshot::Load(ProgramInfoMap& recordings) const
+{
+  if (!XBMC->FileExists(m_filePath.c_str(), false))
+    return false;
+  void *file = XBMC->OpenFile(m_filePath.c_str(), 0);
+  if (!file)
+  {
+    XBMC->Log(LOG_ERROR, "%s: Failed to open snapshot %s", __FUNCTION__, m_filePath.c_str());
+    return false;
+  }
+  std::string buf;
+  int64_t len = XBMC->GetFileLength(file);
+  if (len > 0)
+    buf.reserve((size_t)len);
+  char *chunk = new char[SNAPSHOT_BUFFER_SIZE];
+  ssize_t s;
+  while ((s = XBMC->ReadFile(file, chunk, SNAPSHOT_BUFFER_SIZE)) > 0)
+    buf.append(chunk, (size_t)s);
+  delete[] chunk;
+  XBMC->CloseFile(file);
+
+  Reader r(buf);
+  char magic[SNAPSHOT_MAGIC_LEN];
+  if (!r.Get(magic, SNAPSHOT_MAGIC_LEN) || memcmp(magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LEN) != 0 ||
+          r.GetU32() != SNAPSHOT_BYTEORDER || r.GetU32() != c_version)
+  {
+    XBMC->Log(LOG_NOTICE, "%s: Snapshot has unknown format", __FUNCTION__);
+    return false;
+  }
+  if (r.GetString() != m_backend || r.GetU32() != m_serviceVersion)
+  {
+    XBMC->Log(LOG_NOTICE, "%s: Snapshot belongs to another backend", __FUNCTION__);
+    return false;
+  }
+
+  ProgramInfoMap snapshot;
+  uint32_t count = r.GetU32();
+  // The count is not trusted before the entries are read: a corrupt one must not allocate
+  if (r.IsOk() && count <= r.Remaining() / SNAPSHOT_ENTRY_MIN)
+    snapshot.reserve(count);
+  for (uint32_t i = 0; i < count && r.IsOk(); ++i)
+  {
+    Myth::ProgramPtr program(new Myth::Program());
+    ReadProgram(r, *program);
+    MythProgramInfo prog(program);
+    prog.SetPropsVideoFrameRate(r.GetFloat());
+    prog.SetPropsVideoAspec(r.GetFloat());
+    if (r.IsOk())
+      snapshot.insert(std::make_pair(prog.Key(), prog));
+  }
+  if (!r.IsOk())
+  {
+    XBMC->Log(LOG_ERROR, "%s: Snapshot is truncated", __FUNCTION__);
+    return false;
+  }
+  recordings.swap(snapshot);
+  XBMC->Log(LOG_DEBUG, "%s: Loaded %u recordings", __FUNCTION__, (unsigned)recordings.size());
+  return true;
+}
+
+bool RecordingsSnapshot::Save(const ProgramInfoMap& recordings) const
+{
+  std::string buf;
+  Writer w(buf);
+  w.Put(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LEN);
+  w.PutU32(SNAPSHOT_BYTEORDER);
+  w.PutU32(c_version);
+  w.PutString(m_backend);
+  w.PutU32(m_serviceVersion);
+  w.PutU32((uint32_t)recordings.size());
+  for (ProgramInfoMap::const_iterator it = recordings.begin(); it != recordings.end(); ++it)
+  {
+    Myth::ProgramPtr program = it->second.GetPtr();
+    if (program)
+      WriteProgram(w, *program);
+    else
+      WriteProgram(w, Myth::Program()); // Keep the count consistent
+    w.PutFloat(it->second.GetPropsVideoFrameRate());
+    w.PutFloat(it->second.GetPropsVideoAspec());
+  }
+
+  void *file = XBMC->OpenFileForWrite(m_filePath.c_str(), true);
+  if (!file)
+  {
+    XBMC->Log(LOG_ERROR, "%s: Failed to create snapshot %s", __FUNCTION__, m_filePath.c_str());
+    return false;
+  }
+  const char *p = buf.data();
+  size_t s = buf.size();
+  while (s > 0)
+  {
+    ssize_t bw = XBMC->WriteFile(file, p, s);
+    if (bw <= 0)
+      break;
+    s -= (size_t)bw;
+    p += bw;
+  }
+  XBMC->CloseFile(file);
+  if (s > 0)
+  {
+    XBMC->Log(LOG_ERROR, "%s: Failed to write snapshot %s", __FUNCTION__, m_filePath.c_str());
+    XBMC->DeleteFile(m_filePath.c_str());
+    return false;
+  }
+  XBMC->Log(LOG_DEBUG, "%s: Saved %u recordings", __FUNCTION__, (unsigned)recordings.size());
+  return true;
+}
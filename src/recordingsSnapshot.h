@@ -0,0 +1,48 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2014 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301 USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "cppmyth/MythProgramInfo.h"
+
+#include <string>
+
+/**
+ * Binary snapshot of the recordings map, stored in the user path. It allows
+ * to serve the recordings at startup before the list is fetched from the
+ * backend. The snapshot is bound to the backend and the service version which
+ * wrote it, and is ignored on any mismatch.
+ */
+class RecordingsSnapshot
+{
+public:
+  static const uint32_t c_version = 1;  // Bump on any change of the layout
+
+  RecordingsSnapshot(const std::string& backend, unsigned serviceVersion);
+
+  bool Load(ProgramInfoMap& recordings) const;
+  bool Save(const ProgramInfoMap& recordings) const;
+
+private:
+  std::string m_filePath;
+  std::string m_backend;
+  unsigned m_serviceVersion;
+};
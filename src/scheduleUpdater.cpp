@@ -0,0 +1,83 @@
+/*
+ *      Copyright (C) 2005-2014 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301 USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "scheduleUpdater.h"
+#include "client.h"
+#include "tools.h"
+
+using namespace ADDON;
+using namespace P8PLATFORM;
+
+ScheduleUpdater::ScheduleUpdater(ScheduleUpdaterConsumer *consumer)
+: CThread()
+, m_consumer(consumer)
+, m_changed()
+, m_changes(0)
+{
+  CreateThread();
+}
+
+ScheduleUpdater::~ScheduleUpdater()
+{
+  StopThread(-1); // Set stopping. don't wait as we need to signal the thread first
+  m_changed.Signal();
+  StopThread(); // Wait for thread to stop
+}
+
+void ScheduleUpdater::PushChange()
+{
+  CLockObject lock(m_lock);
+  ++m_changes;
+  m_changed.Signal();
+}
+
+void *ScheduleUpdater::Process()
+{
+  XBMC->Log(LOG_DEBUG, "%s: ScheduleUpdater Thread Started", __FUNCTION__);
+
+  while (!IsStopped())
+  {
+    m_changed.Wait();
+    if (IsStopped())
+      break;
+
+    // Wait until the burst settles or the maximum delay expires
+    WaitBurstSettled(*this, m_changed, (g_iScheduleQuietPeriod > 0 ? g_iScheduleQuietPeriod * 1000 : 0),
+            (g_iScheduleMaxDelay > 0 ? g_iScheduleMaxDelay * 1000 : 0));
+    if (IsStopped())
+      break;
+
+    CLockObject lock(m_lock);
+    unsigned changes = m_changes;
+    m_changes = 0;
+    lock.Unlock();
+    if (changes == 0)
+      continue;
+
+    if (g_bExtraDebug)
+      XBMC->Log(LOG_DEBUG, "%s: Reloading schedule for %u changes", __FUNCTION__, changes);
+    m_consumer->HandleScheduleUpdate();
+  }
+
+  XBMC->Log(LOG_DEBUG, "%s: ScheduleUpdater Thread Stopped", __FUNCTION__);
+  return NULL;
+}
@@ -0,0 +1,56 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2014 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 51 Franklin Street, Fifth Floor, Boston,
+ *  MA 02110-1301 USA
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <p8-platform/threads/threads.h>
+
+class ScheduleUpdaterConsumer
+{
+public:
+  virtual ~ScheduleUpdaterConsumer() {};
+  virtual void HandleScheduleUpdate() = 0;
+};
+
+/**
+ * Collapses the bursts of SCHEDULE_CHANGE events, as sent by the backend
+ * scheduler after a guide update, into one schedule reload. The reload is
+ * handed over to the consumer on its own thread once no change arrived for the
+ * quiet period, or when the maximum delay expires during a long burst. Both
+ * delays are read from the settings at the start of each burst.
+ */
+class ScheduleUpdater : public P8PLATFORM::CThread
+{
+public:
+  ScheduleUpdater(ScheduleUpdaterConsumer *consumer);
+  virtual ~ScheduleUpdater();
+
+  void PushChange();
+
+protected:
+  void *Process();
+
+private:
+  ScheduleUpdaterConsumer *m_consumer;
+  P8PLATFORM::CMutex m_lock;
+  P8PLATFORM::CEvent m_changed;
+  unsigned m_changes;               ///< Changes pushed since the last reload
+};
@@ -22,6 +22,8 @@
  */
 
 #include <p8-platform/os.h>
+#include <p8-platform/threads/threads.h>
+#include <p8-platform/util/timeutils.h>
 #include <math.h>
 
 #ifdef __WINDOWS__
@@ -70,3 +72,23 @@ static inline void timeadd(time_t *time, double diffsec)
   newtm.tm_sec += (int)(diffsec - dh * INTERVAL_HOUR);
   *time = mktime(&newtm);
 }
+
+/**
+ * Wait until no signal came on event for the quiet period, or the maximum
+ * delay expires, or the thread is stopped. The time left is read once per
+ * turn, as Wait(0) would wait forever.
+ */
+static inline void WaitBurstSettled(P8PLATFORM::CThread& thread, P8PLATFORM::CEvent& event, uint32_t quietPeriod, uint32_t maximumDelay)
+{
+  if (quietPeriod == 0)
+    return;
+  P8PLATFORM::CTimeout deadline(maximumDelay);
+  while (!thread.IsStopped())
+  {
+    uint32_t left = deadline.TimeLeft();
+    if (left == 0)
+      break;
+    if (!event.Wait(left < quietPeriod ? left : quietPeriod))
+      break;
+  }
+}